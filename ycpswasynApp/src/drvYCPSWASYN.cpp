@@ -22,6 +22,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 #include <getopt.h>
@@ -32,6 +33,7 @@
 #include <math.h>
 #include <sys/mman.h>
 #include <sched.h>
+#include <time.h>
 #include <epicsTypes.h>
 #include <epicsTime.h>
 #include <epicsThread.h>
@@ -39,14 +41,33 @@
 #include <epicsTimer.h>
 #include <epicsMutex.h>
 #include <epicsEvent.h>
+#include <epicsGuard.h>
+#include <epicsAtomic.h>
 #include <iocsh.h>
 #include <sha1.hpp>
 #include <ctype.h>
 #include <iomanip>
 #include <stdexcept>
+#include <fnmatch.h>
 
 #include <dbAccess.h>
+#include <alarm.h>
+#include <recGbl.h>
+#include <devSup.h>
+#include <longinRecord.h>
+#include <longoutRecord.h>
+#include <aiRecord.h>
+#include <aoRecord.h>
+#include <biRecord.h>
+#include <boRecord.h>
+#include <mbbiRecord.h>
+#include <mbboRecord.h>
+#include <waveformRecord.h>
+#include <menuFtype.h>
 #include <dbStaticLib.h>
+#include <macLib.h>
+#include <osiFileName.h>
+#include <initHooks.h>
 
 #include "drvYCPSWASYN.h"
 #include "asynPortDriver.h"
@@ -74,14 +95,36 @@ double       YCPSWASYN::defaultScan      = 0.0;
 unsigned int YCPSWASYN::recordNameLenMax = sizeof( ((dbCommon*)0)->name ) - 1;
 std::string  YCPSWASYN::mapFilePath      = "yaml/";
 std::string  YCPSWASYN::debugFilePath    = "/tmp/";
+int          YCPSWASYN::shardCount       = 1;
+int          YCPSWASYN::shardKeyMode     = SHARD_KEY_SUBTREE;
+int          YCPSWASYN::asyncWorkers     = 0;
+double       YCPSWASYN::asyncPollPeriod  = 0.0;
+int          YCPSWASYN::arrayChunkSize   = 0;
+int          YCPSWASYN::prefetchThreads  = 0;
+int          YCPSWASYN::deviceTripCount  = 0;
+int          YCPSWASYN::discoveryThreads = 1;
+std::string  YCPSWASYN::generationCachePath = "";
+int          YCPSWASYN::batchLoad        = 1;
+int          YCPSWASYN::lazyInterfaces   = 0;
+std::vector<YCPSWASYNPathFilter> YCPSWASYN::pathFilters;
+int          YCPSWASYN::deferredInit     = 0;
+std::vector<YCPSWASYN*>             YCPSWASYN::deferredPorts_;
+
+epicsMutex                          YCPSWASYN::leafClassLock_;
+std::map<Child, YCPSWASYNLeafClass> YCPSWASYN::leafClasses_;
+unsigned long                       YCPSWASYN::exceptionsAvoided_ = 0;
+YCPSWASYNPhaseStats                 YCPSWASYN::initPhase_;
+std::vector<YCPSWASYN*>             YCPSWASYN::ports_;
+YCPSWASYNPhaseStats                 YCPSWASYN::iocInitPhase_;
+YCPSWASYNPhaseTimer                 *YCPSWASYN::iocInitTimer_ = NULL;
+double       YCPSWASYN::deviceProbePeriod = 5.0;
 
 YCPSWASYN::YCPSWASYN(const char *portName, Path p, const char *recordPrefix, int autogenerationMode, const char* dictionary)
     : asynPortDriver(
         portName,                                                                                   // Port Name
         MAX_SIGNALS,                                                                                // Max Address
-        asynInt32Mask | asynDrvUserMask | asynInt16ArrayMask | asynInt32ArrayMask | asynOctetMask | \
-        asynFloat64ArrayMask | asynUInt32DigitalMask | asynFloat64Mask,                             // Interface Mask
-        asynInt16ArrayMask | asynInt32ArrayMask | asynInt32Mask | asynUInt32DigitalMask,            // Interrupt Mask
+        INTERFACE_MASK,                                                                             // Interface Mask
+        INTERRUPT_MASK,                                                                             // Interrupt Mask
         ASYN_MULTIDEVICE | ASYN_CANBLOCK,                                                           // asynFlags
         1,                                                                                          // Autoconnect
         0,                                                                                          // Default priority
@@ -97,8 +140,31 @@ YCPSWASYN::YCPSWASYN(const char *portName, Path p, const char *recordPrefix, int
     nFO(0),
     nFW(0),
     recordCount(0),
-    autogenerationMode_(autogenerationMode)
+    genCacheFile(NULL),
+    dbBatchFile(NULL),
+    dbBatchMacros_(NULL),
+    autogenerationMode_(autogenerationMode),
+    currentShard_(this),
+    workers_(NULL),
+    commandExecutor_(NULL),
+    generateDB_(NULL),
+    cached_(false)
 {
+    YCPSWASYNPhaseTimer totalTimer(total_);
+
+    shards_.push_back(this);
+
+    // The root path was looked up just before creating the port. Its iocInit phase is timed later.
+    phases_[PHASE_INIT] = initPhase_;
+    total_              = initPhase_;
+    initPhase_          = YCPSWASYNPhaseStats();
+    ports_.push_back(this);
+
+    // Transactions can be done while the registers are added
+    createLatencyParams();
+
+    if (asyncWorkers > 0)
+        workers_ = new YCPSWASYNWorkerPool(portName, asyncWorkers);
 
     // In mode 1 (auto-generation using maps, check the PV name length respect to the prefix's
     if ( ( autogenerationMode_ == 1 ) && ( recordNameLenMax <= ( recordPrefix_.length() + 4 ) ) )
@@ -109,11 +175,151 @@ YCPSWASYN::YCPSWASYN(const char *portName, Path p, const char *recordPrefix, int
         fprintf( stderr, "Using default length (%d) instead\n", recordNameLenMax );
     }
 
+    if (dictionary)
+        dictionary_ = dictionary;
+
+    if (autogenerationMode_)
+    {
+        createShards();
+    }
+    else if (shardCount > 1)
+    {
+        printf("Shards are only used for auto-generated registers. Port %s will not be split.\n", portName);
+    }
+
+    // The discovery and the rest of the initialization add their own time to the total
+    totalTimer.stop();
+
+    // The port is initialized later, together with the other deferred ports
+    if (deferredInit)
+    {
+        printf("Port %s registered. It will be initialized by YCPSWASYNInitPorts.\n", portName);
+        deferredPorts_.push_back(this);
+        return;
+    }
+
+    if (autogenerationMode_)
+        discoverDatabase();
+
+    completeInit();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// int YCPSWASYN::initDeferredPorts(void)                                          //
+// - Initialize the ports registered by YCPSWASYNConfig in deferred mode. Their    //
+//   discovery phase is run on one thread per port, at the same time, and then     //
+//   their records are loaded one port at a time, as dbLoadRecords is not thread   //
+//   safe.                                                                         //
+/////////////////////////////////////////////////////////////////////////////////////
+int YCPSWASYN::initDeferredPorts(void)
+{
+    YCPSWASYNPortDiscovery discovery;
+    std::vector<double>    loadSeconds;
+    epicsTimeStamp         start, discovered, end;
+    int                    failed = 0;
+
+    if (deferredPorts_.empty())
+    {
+        printf("There are no ports waiting to be initialized\n");
+        return 0;
+    }
+
+    discovery.ports.swap(deferredPorts_);
+    discovery.seconds.resize(discovery.ports.size(), 0.0);
+    discovery.running = discovery.ports.size();
+    loadSeconds.resize(discovery.ports.size(), 0.0);
+
+    epicsTimeGetCurrent(&start);
+
+    for (std::size_t i = 0; i < discovery.ports.size(); ++i)
+    {
+        std::stringstream threadName;
+        threadName << "YCPSWASYN_I" << i;
+
+        if ( ! epicsThreadCreate(threadName.str().c_str(), epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackBig), (EPICSTHREADFUNC)YCPSWASYN::discoveryPortTask, &discovery) )
+        {
+            printf("ERROR: Unable to create discovery thread %s\n", threadName.str().c_str());
+            ++failed;
+        }
+    }
+
+    // The threads which could not be created are run here
+    for (int i = 0; i < failed; ++i)
+        discoveryPortTask(&discovery);
+
+    discovery.done.wait();
+
+    epicsTimeGetCurrent(&discovered);
+
+    for (std::size_t i = 0; i < discovery.ports.size(); ++i)
+    {
+        epicsTimeStamp portStart, portEnd;
+
+        epicsTimeGetCurrent(&portStart);
+        discovery.ports[i]->completeInit();
+        epicsTimeGetCurrent(&portEnd);
+
+        loadSeconds[i] = epicsTimeDiffInSeconds(&portEnd, &portStart);
+    }
+
+    epicsTimeGetCurrent(&end);
+
+    printf("Initialization of the deferred ports:\n");
+    printf("    %-20s %14s %12s\n", "Port", "Discovery (s)", "Load (s)");
+    for (std::size_t i = 0; i < discovery.ports.size(); ++i)
+        printf("    %-20s %14.6f %12.6f\n", discovery.ports[i]->portName_, discovery.seconds[i], loadSeconds[i]);
+    printf("    %-20s %14.6f %12.6f\n", "Total", epicsTimeDiffInSeconds(&discovered, &start), epicsTimeDiffInSeconds(&end, &discovered));
+
+    return 0;
+}
+
+void YCPSWASYN::discoveryPortTask(void *arg)
+{
+    YCPSWASYNPortDiscovery *d = static_cast<YCPSWASYNPortDiscovery*>(arg);
+    size_t                 i;
+
+    while ( ( i = epicsAtomicIncrIntT(&d->next) - 1 ) < d->ports.size() )
+    {
+        YCPSWASYN      *port = d->ports[i];
+        epicsTimeStamp start, end;
+
+        epicsTimeGetCurrent(&start);
+        if (port->autogenerationMode_)
+            port->discoverDatabase();
+        epicsTimeGetCurrent(&end);
+
+        d->seconds[i] = epicsTimeDiffInSeconds(&end, &start);
+    }
+
+    if (epicsAtomicDecrIntT(&d->running) == 0)
+        d->done.signal();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::completeInit(void)                                              //
+// - Initialization of the port after its discovery phase: records, parameters,    //
+//   prefetch and health thread                                                    //
+/////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::completeInit(void)
+{
+    YCPSWASYNPhaseTimer totalTimer(total_);
+
     if (autogenerationMode_)
         autogenerateDatabase();
 
+    loadDBFromFile(dictionary_.c_str());
 
-    loadDBFromFile(dictionary);
+    // All registers have been added. Release the unused space on the register tables.
+    currentShard_ = this;
+    for (std::size_t i = 0; i < shards_.size(); ++i)
+    {
+        shards_[i]->ro.compact();
+        shards_[i]->rw.compact();
+        shards_[i]->fo.compact();
+        shards_[i]->fw.compact();
+        shards_[i]->cmd.compact();
+    }
 
     // Create parameters and load records related to save/load default functions
     createParam(DEV_CONFIG, loadConfigString,       asynParamInt32,         &loadConfigValue_);
@@ -134,9 +340,86 @@ YCPSWASYN::YCPSWASYN(const char *portName, Path p, const char *recordPrefix, int
     setStringParam(DEV_CONFIG,      saveConfigRootValue_, "");
     setUIntDigitalParam(DEV_CONFIG, saveConfigStatusValue_, CONFIG_STAT_IDLE, PROCESS_CONFIG_MASK);
     setUIntDigitalParam(DEV_CONFIG, loadConfigStatusValue_, CONFIG_STAT_IDLE, PROCESS_CONFIG_MASK);
+
+    // Device health parameters, updated by the probe thread
+    createParam(DEV_CONFIG, devicesDownString,      asynParamInt32,         &devicesDownValue_);
+    createParam(DEV_CONFIG, deviceErrorsString,     asynParamInt32,         &deviceErrorsValue_);
+    setIntegerParam(DEV_CONFIG, devicesDownValue_,  0);
+    setIntegerParam(DEV_CONFIG, deviceErrorsValue_, 0);
+
+    if (prefetchThreads > 0)
+    {
+        YCPSWASYNPhaseTimer timer(phases_[PHASE_PREFETCH]);
+        prefetchRegisters();
+    }
+
+    if ( workers_ && ( asyncPollPeriod > 0 ) )
+    {
+        std::string threadName = std::string(portName_) + "_A";
+
+        if ( ! epicsThreadCreate(threadName.c_str(), epicsThreadPriorityLow,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)YCPSWASYN::pollTask, this) )
+            printf("ERROR: Unable to create poll thread %s\n", threadName.c_str());
+    }
+
+    if (deviceTripCount > 0)
+    {
+        std::string threadName = std::string(portName_) + "_H";
+
+        if ( ! epicsThreadCreate(threadName.c_str(), epicsThreadPriorityLow,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)YCPSWASYN::healthTask, this) )
+            printf("ERROR: Unable to create device health thread %s\n", threadName.c_str());
+    }
+
+    totalTimer.stop();
+
+    printf("Startup profile of port %s:\n", portName_);
+    printStartupProfile(stdout);
+    writeStartupProfile();
 }
 
 
+YCPSWASYN::YCPSWASYN(const char *portName, Path p, YCPSWASYN *mainPort)
+    : asynPortDriver(
+        portName,                                                                                   // Port Name
+        MAX_SIGNALS,                                                                                // Max Address
+        INTERFACE_MASK,                                                                             // Interface Mask
+        INTERRUPT_MASK,                                                                             // Interrupt Mask
+        ASYN_MULTIDEVICE | ASYN_CANBLOCK,                                                           // asynFlags
+        1,                                                                                          // Autoconnect
+        0,                                                                                          // Default priority
+        0),                                                                                         // Default stack size
+    driverName_(DRIVER_NAME),
+    p_(p),
+    portName_(this->portName),
+    recordPrefix_(mainPort->recordPrefix_),
+    nRO(0),
+    nRW(0),
+    nCMD(0),
+    nSTM(0),
+    nFO(0),
+    nFW(0),
+    recordCount(0),
+    genCacheFile(NULL),
+    dbBatchFile(NULL),
+    dbBatchMacros_(NULL),
+    autogenerationMode_(0),
+    currentShard_(this),
+    workers_(NULL),
+    commandExecutor_(NULL),
+    generateDB_(NULL),
+    cached_(false)
+{
+    // A shard only holds registers, which are added by its main port during the
+    // auto-generation. Its parameters are served by its own asyn queue thread.
+    shards_.push_back(this);
+
+    createLatencyParams();
+
+    if (asyncWorkers > 0)
+        workers_ = new YCPSWASYNWorkerPool(this->portName, asyncWorkers);
+}
+
 ///////////////////////////////////
 // + Stream acquisition routines //
 ///////////////////////////////////
@@ -273,7 +556,8 @@ class IYamlSetIP : public IYamlFixup
 
 int YCPSWASYN::YCPSWASYNInit(const char* rootPath, Path *p, const char* namedRoot)
 {
-    Path root;
+    YCPSWASYNPhaseTimer timer(initPhase_);
+    Path                root;
 
     // Try first to get the root from the cpswLoadYamlFile module
     if ( ( ! namedRoot ) || ( namedRoot[0] == '\0' ) )
@@ -325,30 +609,57 @@ int YCPSWASYN::YCPSWASYNInit(const char* rootPath, Path *p, const char* namedRoo
 // - Load a EPICS record with the provided information                                     //
 /////////////////////////////////////////////////////////////////////////////////////////////
 //template <typename T>
-int YCPSWASYN::LoadRecord(int regType, const recordParams& rp, const string& dbParams, Path p)
+int YCPSWASYN::LoadRecord(int regType, const recordParams& rp, const string& dbParams, Path p, int element)
 {
+    YCPSWASYNPhaseTimer timer(phases_[PHASE_RECORDS]);
     int paramIndex;
     stringstream dbParamsLocal;
 
     // Create list of parameter to pass to the  dbLoadRecords function
     dbParamsLocal.str("");
-    dbParamsLocal << "PORT=" << portName_;
+    dbParamsLocal << "PORT=" << currentShard_->portName;
     dbParamsLocal << ",ADDR=" << regType;
     dbParamsLocal << ",R=" << rp.recName;
     dbParamsLocal << ",PARAM=" << rp.paramName;
     dbParamsLocal << ",DESC=" << rp.recDesc;
     dbParamsLocal << dbParams;
 
-    // Create the asyn parameter
-    createParam(regType, rp.paramName.c_str(), rp.paramType, &paramIndex);
+    // With asynchronous workers, the records of scalar registers, and of RO integer array registers,
+    // use the asynchronous device support, which completes them when their access is done. I/O Intr
+    // records keep the asyn one.
+    if ( ( asyncWorkers > 0 ) && ( regType <= DEV_FLOAT_RW ) && ( dbParams.find(",SCAN=I/O Intr") == std::string::npos ) )
+    {
+        if (rp.paramType == asynParamInt32)
+            dbParamsLocal << ",DTYP=" << ASYNC_DTYP_INT32;
+        else if (rp.paramType == asynParamUInt32Digital)
+            dbParamsLocal << ",DTYP=" << ASYNC_DTYP_DIGITAL;
+        else if (rp.paramType == asynParamFloat64)
+            dbParamsLocal << ",DTYP=" << ASYNC_DTYP_FLOAT64;
+        else if ( ( regType == DEV_REG_RO ) && ( ( rp.paramType == asynParamInt8Array ) ||
+                  ( rp.paramType == asynParamInt16Array ) || ( rp.paramType == asynParamInt32Array ) ) )
+            dbParamsLocal << ",DTYP=" << ASYNC_DTYP_ARRAY_IN;
+    }
+
+    // Create the asyn parameter on the shard that will hold the register
+    currentShard_->createParam(regType, rp.paramName.c_str(), rp.paramType, &paramIndex);
 
-    // Create the record
-    dbLoadRecords(rp.recTemplate.c_str(), dbParamsLocal.str().c_str());
+    // Create the record. During the auto-generation it is written to one database, loaded at the end.
+    if ( ! ( dbBatchFile && batchRecord(rp.recTemplate, dbParamsLocal.str()) ) )
+        dbLoadRecords(rp.recTemplate.c_str(), dbParamsLocal.str().c_str());
 
     // Write the record name to the PV list file
     pvDumpFile->write("%s%*s", rp.recName.c_str(), recordNameLenMax - rp.recName.size() + 4, "");
     pvDumpFile->write("# %s (%s)\n", getNameWithoutLeafIndexes(p).c_str(), regInterfaceTypeNames[regType]);
 
+    // Save the record on the auto-generation cache
+    if (genCacheFile)
+    {
+        genCacheFile->write("R\t%d\t%d\t%d\t%s\t%s\t", regType, rp.paramType, element,
+            escapeCacheField(relativePathName(p)).c_str(), escapeCacheField(rp.recTemplate).c_str());
+        genCacheFile->write("%s\t%s\t%s\t%s\n", escapeCacheField(rp.recName).c_str(), escapeCacheField(rp.paramName).c_str(),
+            escapeCacheField(rp.recDesc).c_str(), escapeCacheField(dbParams).c_str());
+    }
+
     // Increment the number of created records
     ++recordCount;
 
@@ -356,6 +667,107 @@ int YCPSWASYN::LoadRecord(int regType, const recordParams& rp, const string& dbP
     return paramIndex;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::batchRecord(const std::string& recTemplate, const std::string& macros); //
+// std::string YCPSWASYN::readTemplate(const std::string& name);                           //
+//                                                                                         //
+// - Expand a record template and write it to the auto-generated database. The template   //
+//   is read only once, and expanded with macLib as dbLoadRecords would do. Templates      //
+//   with include or substitute directives, and records with undefined macros, are not     //
+//   written: false is returned and the record is loaded with dbLoadRecords instead.       //
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::batchRecord(const std::string& recTemplate, const std::string& macros)
+{
+    std::map<std::string, std::string>::iterator it = templates_.find(recTemplate);
+    if (it == templates_.end())
+        it = templates_.insert( std::make_pair(recTemplate, readTemplate(recTemplate)) ).first;
+
+    // Templates which can't be read are loaded with dbLoadRecords
+    if (it->second.empty())
+        return false;
+
+    char **pairs = NULL;
+    long n;
+
+    macPushScope(dbBatchMacros_);
+    macParseDefns(dbBatchMacros_, macros.c_str(), &pairs);
+    if (pairs)
+    {
+        macInstallMacros(dbBatchMacros_, pairs);
+        free(pairs);
+    }
+
+    // The buffer is doubled until the expanded record fits on it
+    if (dbBatchBuffer_.size() < 2 * it->second.size())
+        dbBatchBuffer_.resize(2 * it->second.size());
+
+    while ( labs( n = macExpandString(dbBatchMacros_, it->second.c_str(), &dbBatchBuffer_[0], dbBatchBuffer_.size()) )
+            >= static_cast<long>(dbBatchBuffer_.size()) - 1 )
+        dbBatchBuffer_.resize(2 * dbBatchBuffer_.size());
+
+    macPopScope(dbBatchMacros_);
+
+    // Records with undefined macros are loaded with dbLoadRecords, which reports them
+    if (n < 0)
+        return false;
+
+    dbBatchFile->write("%s\n", &dbBatchBuffer_[0]);
+
+    return true;
+}
+
+std::string YCPSWASYN::readTemplate(const std::string& name)
+{
+    std::vector<std::string> candidates;
+    const char               *includePath = getenv("EPICS_DB_INCLUDE_PATH");
+
+    if ( includePath && ( name[0] != '/' ) )
+    {
+        std::string path(includePath);
+        std::size_t start = 0, end;
+
+        do
+        {
+            end = path.find(OSI_PATH_LIST_SEPARATOR, start);
+            std::string dir = path.substr(start, end - start);
+            if (!dir.empty())
+                candidates.push_back(dir + OSI_PATH_SEPARATOR + name);
+            start = end + 1;
+        }
+        while (end != std::string::npos);
+    }
+    candidates.push_back(name);
+
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        std::ifstream templateFile(candidates[i].c_str());
+        if (templateFile.is_open())
+        {
+            stringstream text;
+            text << templateFile.rdbuf();
+
+            // Directives are only followed by dbLoadRecords
+            std::string line;
+            while (std::getline(text, line))
+            {
+                std::size_t start = line.find_first_not_of(" \t");
+                if ( ( start != std::string::npos ) &&
+                     ( ( line.compare(start, 7, "include") == 0 ) || ( line.compare(start, 10, "substitute") == 0 ) ) )
+                {
+                    printf("Template \"%s\" has include or substitute directives. Its records will be loaded one at a time.\n", name.c_str());
+                    return std::string();
+                }
+            }
+
+            return text.str();
+        }
+    }
+
+    printf("Template \"%s\" not found. Its records will be loaded one at a time.\n", name.c_str());
+
+    return std::string();
+}
+
 //////////////////////////////////////
 // + template <typename T>          //
 //   int getRegType(const T& reg);  //
@@ -403,57 +815,281 @@ int YCPSWASYN::getRegType(const Stream& reg)
 //////////////////////////////////////
 
 
-/////////////////////////////////////////////////////////////////
-// + template <typename T>                                     //
-//   void pushParameter(const T& reg, const int& parmaIndex);  //
-//                                                             //
-// - Push the register pointer to its respective list based    //
-//   on the parameter index                                    //
-/////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+// + template <typename T>                                                   //
+//   void pushParameter(const T& reg, const int& parmaIndex, const Path& p); //
+//                                                                           //
+// - Push the register pointer to its respective list based                  //
+//   on the parameter index                                                  //
+///////////////////////////////////////////////////////////////////////////////
 template <>
-void YCPSWASYN::pushParameter(const ScalVal_RO& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const ScalVal_RO& reg, const int& paramIndex, const Path& p)
 {
-    ro[paramIndex] = reg;
+    ro.insert(paramIndex, reg, getDevice(p));
+    createArrayWindow(ro.at(paramIndex), DEV_REG_RO, paramIndex, reg->getNelms());
+    if ( !ro.at(paramIndex).dev->probe && ( reg->getNelms() == 1 ) )
+        ro.at(paramIndex).dev->probe = reg;
     nRO++;
 }
 
 template <>
-void YCPSWASYN::pushParameter(const ScalVal& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const ScalVal& reg, const int& paramIndex, const Path& p)
 {
-    rw[paramIndex] = reg;
+    rw.insert(paramIndex, reg, getDevice(p));
+    createArrayWindow(rw.at(paramIndex), DEV_REG_RW, paramIndex, reg->getNelms());
+    if ( !rw.at(paramIndex).dev->probe && ( reg->getNelms() == 1 ) )
+        rw.at(paramIndex).dev->probe = reg;
     nRW++;
 }
 
 template <>
-void YCPSWASYN::pushParameter(const DoubleVal_RO& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const DoubleVal_RO& reg, const int& paramIndex, const Path& p)
 {
-    fo[paramIndex] = reg;
+    fo.insert(paramIndex, reg, getDevice(p));
+    createArrayWindow(fo.at(paramIndex), DEV_FLOAT_RO, paramIndex, reg->getNelms());
+    if ( !fo.at(paramIndex).dev->probeDouble && ( reg->getNelms() == 1 ) )
+        fo.at(paramIndex).dev->probeDouble = reg;
     nFO++;
 }
 
 template <>
-void YCPSWASYN::pushParameter(const DoubleVal& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const DoubleVal& reg, const int& paramIndex, const Path& p)
 {
-    fw[paramIndex] = reg;
+    fw.insert(paramIndex, reg, getDevice(p));
+    createArrayWindow(fw.at(paramIndex), DEV_FLOAT_RW, paramIndex, reg->getNelms());
+    if ( !fw.at(paramIndex).dev->probeDouble && ( reg->getNelms() == 1 ) )
+        fw.at(paramIndex).dev->probeDouble = reg;
     nFW++;
 }
 
 template <>
-void YCPSWASYN::pushParameter(const Command& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const Command& reg, const int& paramIndex, const Path& p)
 {
-    cmd[paramIndex] = reg;
+    cmd.insert(paramIndex, reg, getDevice(p));
+    createCommandStatus(paramIndex);
     nCMD++;
 }
 
 template <>
-void YCPSWASYN::pushParameter(const Stream& reg, const int& paramIndex)
+void YCPSWASYN::pushParameter(const Stream& reg, const int& paramIndex, const Path& p)
 {
     nSTM++;
 }
-/////////////////////////////////////////////////////////////////
-// - template <typename T>                                     //
-//   void pushParameter(const T& reg, const int& parmaIndex);  //
-/////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::deferParameter(int regType, const int& paramIndex,            //
+//                                const Path& p);                                //
+//                                                                               //
+// - Push a register whose interface is created the first time it is accessed.  //
+//   Only the probe register of each device is created right away.             //
+///////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::deferParameter(int regType, const int& paramIndex, const Path& p)
+{
+    YCPSWASYNDevice *dev   = getDevice(p);
+    unsigned        nelms  = p->getNelms();
+
+    switch (regType)
+    {
+        case DEV_REG_RO:
+            ro.defer(paramIndex, p, dev);
+            createArrayWindow(ro.at(paramIndex), DEV_REG_RO, paramIndex, nelms);
+            nRO++;
+            break;
+        case DEV_REG_RW:
+            rw.defer(paramIndex, p, dev);
+            createArrayWindow(rw.at(paramIndex), DEV_REG_RW, paramIndex, nelms);
+            nRW++;
+            break;
+        case DEV_FLOAT_RO:
+            fo.defer(paramIndex, p, dev);
+            createArrayWindow(fo.at(paramIndex), DEV_FLOAT_RO, paramIndex, nelms);
+            nFO++;
+            break;
+        case DEV_FLOAT_RW:
+            fw.defer(paramIndex, p, dev);
+            createArrayWindow(fw.at(paramIndex), DEV_FLOAT_RW, paramIndex, nelms);
+            nFW++;
+            break;
+        case DEV_CMD:
+            cmd.defer(paramIndex, p, dev);
+            createCommandStatus(paramIndex);
+            nCMD++;
+            return;
+        default:
+            return;
+    }
+
+    // Devices without a register to probe are tried again by the next request
+    if ( ( nelms == 1 ) && !dev->probe && !dev->probeDouble )
+    {
+        try
+        {
+            if ( ( regType == DEV_REG_RO ) || ( regType == DEV_REG_RW ) )
+                dev->probe       = IScalVal_RO::create(p);
+            else
+                dev->probeDouble = IDoubleVal_RO::create(p);
+        }
+        catch (CPSWError &e) {}
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
+// - template <typename T>                                                   //
+//   void pushParameter(const T& reg, const int& parmaIndex, const Path& p); //
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////
+// YCPSWASYNDevice *YCPSWASYN::getDevice(const Path& p);     //
+//                                                           //
+// - Get the device where the register at the given path is  //
+//   located. The device is created the first time it is     //
+//   requested.                                              //
+///////////////////////////////////////////////////////////////
+YCPSWASYNDevice *YCPSWASYN::getDevice(const Path& p)
+{
+    Path parent = p->clone();
+    parent->up();
+
+    std::string key = parent->toString();
+
+    std::map<std::string, YCPSWASYNDevice*>::iterator it = devices_.find(key);
+    if (it != devices_.end())
+        return it->second;
+
+    YCPSWASYNDevice *dev = new YCPSWASYNDevice();
+    dev->name          = key;
+    dev->tripThreshold = deviceTripCount;
+    devices_.insert( std::make_pair(key, dev) );
+
+    return dev;
+}
+
+///////////////////////////////////////////////////////////////
+// void YCPSWASYN::createShards(void);                       //
+//                                                           //
+// - Create the additional asyn ports the auto-generated     //
+//   registers are split across. Each shard has its own asyn //
+//   queue thread, so slow registers in one shard do not     //
+//   delay the requests to registers in other shards.        //
+///////////////////////////////////////////////////////////////
+void YCPSWASYN::createShards(void)
+{
+    if (shardCount <= 1)
+        return;
+
+    printf("Splitting port %s into %d shards (key mode: %s)\n", portName, shardCount,
+        (shardKeyMode == SHARD_KEY_DEVICE) ? "device" : "subtree");
+
+    for (int i = 1; i < shardCount; ++i)
+    {
+        std::stringstream shardName;
+        shardName << portName << SHARD_NAME_SUFFIX << i;
+        shards_.push_back(new YCPSWASYN(shardName.str().c_str(), p_, this));
+    }
+}
+
+///////////////////////////////////////////////////////////////
+// YCPSWASYN *YCPSWASYN::selectShard(const Path& p);         //
+//                                                           //
+// - Select the shard for the register at the given path.    //
+//   All registers of the same device go to the same shard.  //
+///////////////////////////////////////////////////////////////
+YCPSWASYN *YCPSWASYN::selectShard(const Path& p)
+{
+    if (shards_.size() <= 1)
+        return this;
+
+    std::string key = p->toString();
+
+    if (shardKeyMode == SHARD_KEY_DEVICE)
+    {
+        // Hash of the device (parent path) name
+        key = key.substr(0, key.rfind('/'));
+        return shards_.at(epicsStrHash(key.c_str(), 0) % shards_.size());
+    }
+
+    // Top level subtree below the root path. Subtrees are assigned to
+    // the shards in round robin, in the order they are found.
+    std::string root = p_->toString();
+    if (0 == key.compare(0, root.size(), root))
+        key = key.substr(root.size());
+
+    std::size_t first = key.find_first_not_of('/');
+    if (first != std::string::npos)
+        key = key.substr(0, key.find('/', first));
+
+    std::map<std::string, YCPSWASYN*>::iterator it = subtreeShards_.find(key);
+    if (it != subtreeShards_.end())
+        return it->second;
+
+    YCPSWASYN *shard = shards_.at(subtreeShards_.size() % shards_.size());
+    subtreeShards_.insert( std::make_pair(key, shard) );
+
+    return shard;
+}
+
+///////////////////////////////////////////////////////////////
+// void YCPSWASYN::createCommandStatus(int paramIndex);      //
+//                                                           //
+// - Create the parameters where the execution of a command  //
+//   is reported. Commands are run on the command executor   //
+//   thread, which is created with the first command.        //
+///////////////////////////////////////////////////////////////
+void YCPSWASYN::createCommandStatus(int paramIndex)
+{
+    const char             *name;
+    YCPSWASYNCommandStatus cs;
+
+    if (getParamName(DEV_CMD, paramIndex, &name) != asynSuccess)
+        return;
+
+    std::string paramName(name);
+
+    cs.busy = false;
+    createParam(DEV_CMD, (paramName + COMMAND_BUSY_SUFFIX).c_str(),     asynParamInt32,   &cs.busyParam);
+    createParam(DEV_CMD, (paramName + COMMAND_STATUS_SUFFIX).c_str(),   asynParamInt32,   &cs.statusParam);
+    createParam(DEV_CMD, (paramName + COMMAND_DURATION_SUFFIX).c_str(), asynParamFloat64, &cs.durationParam);
+    setUIntDigitalParam(DEV_CMD, paramIndex, 0, 0xFFFFFFFF);
+    setIntegerParam(DEV_CMD, cs.busyParam, 0);
+    setIntegerParam(DEV_CMD, cs.statusParam, CMD_STAT_SUCCESS);
+    setDoubleParam(DEV_CMD, cs.durationParam, 0);
+
+    commandStatus_[paramIndex] = cs;
+
+    if (!commandExecutor_)
+        commandExecutor_ = new YCPSWASYNWorkerPool(std::string(portName) + COMMAND_EXECUTOR_SUFFIX, 1);
+}
+
+///////////////////////////////////////////////////////////////
+// YCPSWASYNFieldGroup *YCPSWASYN::createFieldGroup(         //
+//                          const ScalVal_RO& reg,           //
+//                          const Path& p);                  //
+//                                                           //
+// - Create a group for the fields of an array register,     //
+//   which are published on their own parameters. Separate   //
+//   registers sharing a hardware word are not grouped, as   //
+//   CPSW gives no interface to that word.                   //
+///////////////////////////////////////////////////////////////
+YCPSWASYNFieldGroup *YCPSWASYN::createFieldGroup(const ScalVal_RO& reg, const Path& p)
+{
+    YCPSWASYNFieldGroup *g = new YCPSWASYNFieldGroup();
+
+    g->reg = reg;
+    g->dev = getDevice(p);
+    g->params.resize(reg->getNelms(), -1);
+    g->buffer.resize(reg->getNelms());
+
+    fieldGroups_.push_back(g);
+
+    return g;
+}
+
+void YCPSWASYN::addToFieldGroup(YCPSWASYNFieldGroup *g, int paramIndex, int element)
+{
+    YCPSWASYNRegister<ScalVal_RO>& r = ro.at(paramIndex);
+
+    g->params.at(element) = paramIndex;
+    r.group               = g;
+}
 
 /////////////////////////////////////////////////////////////////////
 // std::string YCPSWASYN::extractMbbxDbParams(const Enum& isEnum); //
@@ -461,6 +1097,10 @@ void YCPSWASYN::pushParameter(const Stream& reg, const int& paramIndex)
 /////////////////////////////////////////////////////////////////////
 std::string YCPSWASYN::extractMbbxDbParams(const Enum& isEnum)
 {
+    // Registers with the same enum (e.g. the elements of an array) share its parameters
+    std::map<Enum, std::string>::iterator found = mbbxDbParams_.find(isEnum);
+    if (found != mbbxDbParams_.end())
+        return found->second;
 
     int nValues = isEnum->getNelms();
     int mBits = ceil(log2(nValues));
@@ -487,9 +1127,27 @@ std::string YCPSWASYN::extractMbbxDbParams(const Enum& isEnum)
         }
     }
 
+    mbbxDbParams_.insert( std::make_pair(isEnum, dbParamsLocal.str()) );
+
     return dbParamsLocal.str();
 }
 
+// asyn parameter type of an integer array register, from the width of its elements. It is
+// used by the auto-generation and by the dictionary, so both serve a register the same way.
+// 8-bit registers use the octet interface (char and string waveforms); narrower and wider
+// registers use the narrowest array interface they fit in.
+static asynParamType arrayParamType(long nBits)
+{
+    if (nBits == 8)
+        return asynParamOctet;
+    else if (nBits < 8)
+        return asynParamInt8Array;
+    else if (nBits <= 16)
+        return asynParamInt16Array;
+    else
+        return asynParamInt32Array;
+}
+
 ///////////////////////////////////////////////////////
 // + template <typename T>                           //
 //   int CreateRecord(const T& reg);                 //
@@ -537,8 +1195,12 @@ int YCPSWASYN::CreateRecord(const T& reg)
     trp.recDesc = string("\"") + string(c->getDescription()).substr(0, DB_DESC_LENGTH_MAX) + string("\"");
 
     // Add the SCAN parameter base on the YAML pollSecs parameter to input registers
+    string scanDbParams;
     if (regType == DEV_REG_RO)
-        dbParams += getEpicsScan(scan);
+    {
+        scanDbParams = getEpicsScan(scan);
+        dbParams    += scanDbParams;
+    }
 
     // Look trough the register properties and create the appropriate record type
     if ((!isEnum) || (isEnum->getNelms() > DB_MBBX_NELEM_MAX))
@@ -557,23 +1219,34 @@ int YCPSWASYN::CreateRecord(const T& reg)
             dbParamsLocal << ",N=" << reg->getNelms();
             dbParams += dbParamsLocal.str();
 
-            if (nBits == 8)
+            trp.paramType = arrayParamType(nBits);
+
+            if (trp.paramType == asynParamOctet)
             {
                 // Create waveform_8_x record
-                trp.paramType = asynParamOctet;
                 arrType       = IScalVal_Base::ASCII == reg->getEncoding() ? REG_STRING : REG_ARRAY_8;
             }
+            else if (trp.paramType == asynParamInt8Array)
+            {
+                // Create waveform_int8_x record
+                arrType       = REG_ARRAY_INT8;
+                dbParams     += reg->isSigned() ? ",FTVL=CHAR" : ",FTVL=UCHAR";
+            }
+            else if (trp.paramType == asynParamInt16Array)
+            {
+                // Create waveform_int16_x record
+                arrType       = REG_ARRAY_16;
+                dbParams     += reg->isSigned() ? ",FTVL=SHORT" : ",FTVL=USHORT";
+            }
             else
             {
                 // Create waveform_x record
-                trp.paramType = asynParamInt32Array;
                 arrType       = REG_ARRAY;
-
             }
         }
         trp.recTemplate = templateList[regType][arrType];
         paramIndex      = LoadRecord(regType, trp, dbParams, p);
-        pushParameter(reg, paramIndex);
+        currentShard_->pushParameter(reg, paramIndex, p);
     }
     else
     {
@@ -587,31 +1260,47 @@ int YCPSWASYN::CreateRecord(const T& reg)
             trp.recTemplate = templateList[regType][arrType];
 
             paramIndex = LoadRecord(regType, trp, dbParams, p);
-            pushParameter(reg, paramIndex);
+            currentShard_->pushParameter(reg, paramIndex, p);
 
         }
         else
         {
-            // Create array of mbbx records
+            // Create array of mbbx records. The parameters of each element are built from
+            // the ones shared by all of them, so their length doesn't grow with the array.
             stringstream index_aux;
-            string c_name;
+            string elementPrefix = c->getName() + string("[");
+            string enumDbParams  = extractMbbxDbParams(isEnum);
             Path pClone = p->clone();
             pClone->up();
 
+            trp.paramType = asynParamUInt32Digital;
+            trp.recTemplate = templateList[regType][arrType];
+
+            // The elements of an input array are read together, with one transaction.
+            // Only the first element is scanned; the others are updated through I/O Intr.
+            YCPSWASYNFieldGroup *group = NULL;
+            if (regType == DEV_REG_RO)
+            {
+                group = currentShard_->createFieldGroup(reg, p);
+
+                if (genCacheFile)
+                    genCacheFile->write("G\t%s\n", escapeCacheField(relativePathName(p)).c_str());
+            }
+
             for (int j = 0 ; j < nElements ; j++)
             {
+                string elementDbParams(dbParams);
+
                 index_aux.str("");
-                index_aux << j;
+                index_aux << elementPrefix << j << "]";
 
-                c_name.clear();
-                c_name = c->getName() + string("[") + index_aux.str() + string("]");
-                Path c_path = pClone->findByName(c_name.c_str());
-                T c_reg = IScalVal::create(c_path);
+                Path c_path = pClone->findByName(index_aux.str().c_str());
+                T c_reg = T::element_type::create(c_path);
 
                 if (regType == DEV_REG_RW)
                 {
                     trp.recName = YCPSWASYN::generateRecordName(c_path, "St");
-                    dbParams += ",R_RBV=" + YCPSWASYN::generateRecordName(c_path, "Rd");
+                    elementDbParams += ",R_RBV=" + YCPSWASYN::generateRecordName(c_path, "Rd");
                 }
                 else
                     trp.recName = YCPSWASYN::generateRecordName(c_path, "Rd");
@@ -620,15 +1309,17 @@ int YCPSWASYN::CreateRecord(const T& reg)
                 pName << string(c->getName()).substr(0, 10) << recordCount;
                 trp.paramName = pName.str();
 
-                Enum isEnumLocal = c_reg->getEnum();
+                elementDbParams += enumDbParams;
 
-                dbParams += extractMbbxDbParams(isEnumLocal);
+                // The SCAN of the register is replaced, so the record has only one
+                if ( group && ( j >= 1 ) )
+                    elementDbParams.replace(elementDbParams.find(scanDbParams), scanDbParams.length(), ",SCAN=I/O Intr");
 
-                trp.paramType = asynParamUInt32Digital;
-                trp.recTemplate = templateList[regType][arrType];
+                paramIndex = LoadRecord(regType, trp, elementDbParams, c_path, j);
+                currentShard_->pushParameter(c_reg, paramIndex, c_path);
 
-                paramIndex = LoadRecord(regType, trp, dbParams, p);
-                pushParameter(c_reg, paramIndex);
+                if (group)
+                    currentShard_->addToFieldGroup(group, paramIndex, j);
             }
         }
     }
@@ -684,7 +1375,7 @@ int YCPSWASYN::CreateRecord(const Command& reg, const Path& p_)
     dbParams += std::string(",ZNAM=\"Run\"");
 
     paramIndex = LoadRecord(regType, trp, dbParams, p);
-    pushParameter(reg, paramIndex);
+    currentShard_->pushParameter(reg, paramIndex, p);
 
     return (arrType << 8) | regType;
 }
@@ -739,13 +1430,24 @@ int YCPSWASYN::CreateRecord(const Stream& reg, const Path& p_)
 
     p16StmIndex = LoadRecord(regType, trp, dbParams, p);
 
+    if (genCacheFile)
+        genCacheFile->write("T\t%s\n", escapeCacheField(relativePathName(p)).c_str());
+
     // Create Acquisition Thread
+    if (startStream(reg, p, p16StmIndex, p32stmIndex))
+        return -1;
+
+    return (REG_STREAM << 8) | regType;
+}
+
+int YCPSWASYN::startStream(const Stream& reg, const Path& p, int param16index, int param32index)
+{
     asynStatus status;
     ThreadArgs *arglist = new ThreadArgs();
-    arglist->pPvt = this;
+    arglist->pPvt = currentShard_;
     arglist->stm = reg;
-    arglist->param16index = p16StmIndex;
-    arglist->param32index = p32stmIndex;
+    arglist->param16index = param16index;
+    arglist->param32index = param32index;
     status = (asynStatus)(epicsThreadCreate("Stream", epicsThreadPriorityLow,
             epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)streamTaskC, arglist) == NULL);
 
@@ -760,7 +1462,7 @@ int YCPSWASYN::CreateRecord(const Stream& reg, const Path& p_)
 
     nSTM++;
 
-    return (REG_STREAM << 8) | regType;
+    return 0;
 }
 ///////////////////////////////////////////////////////
 // - template <typename T>                           //
@@ -834,44 +1536,99 @@ int YCPSWASYN::CreateRecordFloat(const T& reg)
     }
     trp.recTemplate = templateList[regType][arrType];
     paramIndex = LoadRecord(regType, trp, dbParams, p);
-    pushParameter(reg, paramIndex);
+    currentShard_->pushParameter(reg, paramIndex, p);
 
     return (arrType << 8) | regType;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// int YCPSWASYN::CreateRecord(Path p);                                           //
+// void YCPSWASYN::createInterfaces(Path p, YCPSWASYNInterfaces& ifs);            //
+// int YCPSWASYN::CreateRecord(Path p, const YCPSWASYNInterfaces& ifs);           //
+//                                                                                //
+// - Create the records of a register path. createInterfaces attaches its CPSW    //
+//   interfaces, without touching the driver, so the auto-generation runs it on   //
+//   several threads. The records and parameters are then created in order by    //
+//   CreateRecord(p, ifs).                                                        //
+////////////////////////////////////////////////////////////////////////////////////
 int YCPSWASYN::CreateRecord(Path p2)
 {
-    ScalVal         rw_aux;
-    ScalVal_RO      ro_aux;
-    Command         cmd_aux;
-    DoubleVal       fw_aux;
-    DoubleVal_RO    fo_aux;
-    Stream          stm_aux;
-    int             rval = -1;
-    bool            interfaceAttached = false;
+    YCPSWASYNInterfaces ifs;
+
+    createInterfaces(p2, ifs);
+
+    return CreateRecord(p2, ifs);
+}
+
+void YCPSWASYN::createInterfaces(Path p2, YCPSWASYNInterfaces& ifs)
+{
+    Child              c = p2->tail();
+    YCPSWASYNLeafClass cls;
+    bool               known;
 
-    // Try to attach a ScalVal_RO and ScalVal interface
-    try
     {
-        ro_aux = IScalVal_RO::create(p2);
-        interfaceAttached = true;
-        rw_aux = IScalVal::create(p2);
+        epicsGuard<epicsMutex> g(leafClassLock_);
+
+        std::map<Child, YCPSWASYNLeafClass>::iterator it = leafClasses_.find(c);
+        known = ( it != leafClasses_.end() );
+        if (known)
+            cls = it->second;
     }
-    catch (CPSWError &e)
+
+    // The other leaves of a field already probed only get the interfaces of its kind
+    if ( known && createInterfaces(p2, cls.kind, ifs) )
     {
+        epicsGuard<epicsMutex> g(leafClassLock_);
+        exceptionsAvoided_ += cls.exceptions;
+        return;
     }
 
-    // If not interface was attached, try to attached a DoubleVal[_RO] interface
-    if (!interfaceAttached)
+    ifs = YCPSWASYNInterfaces();
+    cls = probeInterfaces(p2, ifs);
+
+    if (!known)
     {
-        try
-        {
-            fo_aux = IDoubleVal_RO::create(p2);
+        epicsGuard<epicsMutex> g(leafClassLock_);
+        leafClasses_.insert( std::make_pair(c, cls) );
+    }
+}
+
+YCPSWASYNLeafClass YCPSWASYN::probeInterfaces(Path p2, YCPSWASYNInterfaces& ifs)
+{
+    YCPSWASYNLeafClass cls;
+    bool               interfaceAttached = false;
+
+    cls.kind       = LEAF_NONE;
+    cls.exceptions = 0;
+
+    // Try to attach a ScalVal_RO and ScalVal interface
+    try
+    {
+        ifs.ro = IScalVal_RO::create(p2);
+        interfaceAttached = true;
+        cls.kind = LEAF_RO;
+        ifs.rw = IScalVal::create(p2);
+        cls.kind = LEAF_RW;
+    }
+    catch (CPSWError &e)
+    {
+        ++cls.exceptions;
+    }
+
+    // If not interface was attached, try to attached a DoubleVal[_RO] interface
+    if (!interfaceAttached)
+    {
+        try
+        {
+            ifs.fo = IDoubleVal_RO::create(p2);
             interfaceAttached = true;
-            fw_aux = IDoubleVal::create(p2);
+            cls.kind = LEAF_FO;
+            ifs.fw = IDoubleVal::create(p2);
+            cls.kind = LEAF_FW;
         }
         catch (CPSWError &e)
         {
+            ++cls.exceptions;
         }
     }
 
@@ -880,11 +1637,13 @@ int YCPSWASYN::CreateRecord(Path p2)
     {
         try
         {
-            cmd_aux = ICommand::create(p2);
+            ifs.cmd = ICommand::create(p2);
             interfaceAttached = true;
+            cls.kind = LEAF_CMD;
         }
         catch (CPSWError &e)
         {
+            ++cls.exceptions;
         }
     }
 
@@ -895,32 +1654,81 @@ int YCPSWASYN::CreateRecord(Path p2)
         {
             try
             {
-                stm_aux = IStream::create(p2);
+                ifs.stm = IStream::create(p2);
+                cls.kind = LEAF_STM;
             }
             catch (CPSWError &e)
             {
+                ++cls.exceptions;
             }
         }
     }
 
+    return cls;
+}
+
+bool YCPSWASYN::createInterfaces(Path p2, int kind, YCPSWASYNInterfaces& ifs)
+{
+    try
+    {
+        switch (kind)
+        {
+            case LEAF_RW:
+                ifs.rw  = IScalVal::create(p2);
+                // Fall through: RW registers also get a RO interface
+            case LEAF_RO:
+                ifs.ro  = IScalVal_RO::create(p2);
+                break;
+            case LEAF_FW:
+                ifs.fw  = IDoubleVal::create(p2);
+                // Fall through
+            case LEAF_FO:
+                ifs.fo  = IDoubleVal_RO::create(p2);
+                break;
+            case LEAF_CMD:
+                ifs.cmd = ICommand::create(p2);
+                break;
+            case LEAF_STM:
+                ifs.stm = IStream::create(p2);
+                break;
+        }
+    }
+    catch (CPSWError &e)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int YCPSWASYN::CreateRecord(Path p2, const YCPSWASYNInterfaces& ifs)
+{
+    int rval = -1;
+
+    // Select the shard where the records of this register will be served
+    currentShard_ = selectShard(p2);
+
+    if (genCacheFile)
+        genCacheFile->write("S\t%s\n", escapeCacheField(relativePathName(p2)).c_str());
+
     // Depending on the attached interface, create a record for it
-    if (ro_aux)
-        rval = YCPSWASYN::CreateRecord(ro_aux);
+    if (ifs.ro)
+        rval = YCPSWASYN::CreateRecord(ifs.ro);
 
-    if (rw_aux)
-        rval = YCPSWASYN::CreateRecord(rw_aux);
+    if (ifs.rw)
+        rval = YCPSWASYN::CreateRecord(ifs.rw);
 
-    if (fo_aux)
-        rval = YCPSWASYN::CreateRecordFloat(fo_aux);
+    if (ifs.fo)
+        rval = YCPSWASYN::CreateRecordFloat(ifs.fo);
 
-    if (fw_aux)
-        rval = YCPSWASYN::CreateRecordFloat(fw_aux);
+    if (ifs.fw)
+        rval = YCPSWASYN::CreateRecordFloat(ifs.fw);
 
-    if (cmd_aux)
-        rval = YCPSWASYN::CreateRecord(cmd_aux, p2);
+    if (ifs.cmd)
+        rval = YCPSWASYN::CreateRecord(ifs.cmd, p2);
 
-    if (stm_aux)
-        rval = YCPSWASYN::CreateRecord(stm_aux, p2);
+    if (ifs.stm)
+        rval = YCPSWASYN::CreateRecord(ifs.stm, p2);
 
     return rval;
 }
@@ -937,13 +1745,21 @@ int YCPSWASYN::CreateRecord(Path p2)
 ////////////////////////////////////////////////////////////////////////////////////////////
 std::string YCPSWASYN::generateRecordName(const Path& p, const std::string& suffix)
 {
+    YCPSWASYNPhaseTimer timer(phases_[PHASE_NAMES]);
     std::string resultPrefix;
 
     // Auto-generation mode 2: generate hashed names
     if (autogenerationMode_ == 2)
     {
+        // The elements of an array have the same name
+        std::string   name = getNameWithoutLeafIndexes(p) + suffix;
+
+        boost::unordered_map<std::string, std::string>::iterator found = hashedNames_.find(name);
+        if (found != hashedNames_.end())
+            return found->second;
+
         char          mdstr[SHA1_HEX_SIZE];
-        std::string   msg = recordPrefix_ + getNameWithoutLeafIndexes(p) + suffix;
+        std::string   msg = recordPrefix_ + name;
 
         sha1 hasher( msg.c_str() );
 
@@ -956,16 +1772,16 @@ std::string YCPSWASYN::generateRecordName(const Path& p, const std::string& suff
         resultPrefix = std::string(mdstr);
 
         // Return a truncated string (if necessary) to satisfy the record max length
-        return resultPrefix.substr(0, recordNameLenMax);
+        resultPrefix = resultPrefix.substr(0, recordNameLenMax);
+        hashedNames_.insert( std::make_pair(name, resultPrefix) );
+
+        return resultPrefix;
     }
 
     Path pLocal = p->clone();
     Child tail;
 
-    std::map<std::string, std::string>::iterator it;
     std::size_t found_bracket;
-    bool found_key, found_top_key;
-    std::string childName, childIndexStr;
     std::string pathStrAux, firstElementIndexStr;
 
     // First element (don't look it up on the map definitions)
@@ -974,8 +1790,6 @@ std::string YCPSWASYN::generateRecordName(const Path& p, const std::string& suff
     if (!tail)
         return std::string();
 
-    resultPrefix = tail->getName();
-
     // Look for the array index, if any
     pathStrAux = pLocal->toString();
     if (*pathStrAux.rbegin() == ']')
@@ -988,81 +1802,83 @@ std::string YCPSWASYN::generateRecordName(const Path& p, const std::string& suff
             firstElementIndexStr.clear();
     }
 
-    // Continue with rest of the path
+    // Continue with rest of the path, which is shared with the sibling registers
     pLocal->up();
-    while (tail = pLocal->tail())
-    {
-        found_top_key = false;
-        found_key = false;
-        found_bracket = std::string::npos;
-        childIndexStr.clear();
+    resultPrefix = getNamePrefix(pLocal) + tail->getName();
 
-        childName = tail->getName();
+    // Truncated string (if necessary) to satisfy the record max length and adding the index to the first element if any
+    // (record prefix length [ +1 from adding ':']) + (record name length) + (first element index length) + (record suffix length) <= record max length
+    resultPrefix = resultPrefix.substr(0, recordNameLenMax - (recordPrefix_.length() + 1) - DB_NAME_SUFFIX_LENGHT - firstElementIndexStr.length()) + firstElementIndexStr;
 
-        // Look for the array index, if any
-        pathStrAux = pLocal->toString();
-        if (*pathStrAux.rbegin() == ']')
-        {
-            found_bracket = pathStrAux.find_last_of('[');
-            childIndexStr = pathStrAux.substr(found_bracket + 1 , pathStrAux.length() - found_bracket - 2);
-        }
+    // Add the record name prefix and suffix
+    resultPrefix += ":" + suffix;
+    if ( recordPrefix_.length() > 0 )
+        resultPrefix = recordPrefix_ + ":" + resultPrefix;
 
-        // Look for keys on the top map definition
-        for (it = mapTop.begin(); it != mapTop.end(); ++it)
-        {
-            found_top_key = ( 0 == childName.compare(it->first) );
+    return resultPrefix;
+}
 
-            if (found_top_key)
-            {
-                childName = it->second;
-                break;
-            }
-        }
+////////////////////////////////////////////////////////////////////////////////////////////
+// std::string YCPSWASYN::getNamePrefix(const Path& p);                                   //
+//                                                                                        //
+// - Record name prefix of the registers in a hub path: the (substituted) names of the    //
+//   hubs, up to the first one found on the top map, separated by ':'. It is built once   //
+//   per hub path, from the prefix of its parent.                                         //
+////////////////////////////////////////////////////////////////////////////////////////////
+std::string YCPSWASYN::getNamePrefix(const Path& p)
+{
+    Child tail = p->tail();
 
-        // If key was not fount on opt map, look for keys on the map definition
-        if (!found_top_key)
-        {
-            for (it = map.begin(); it != map.end(); ++it)
-            {
-                found_key = ( 0 == childName.compare(it->first) );
+    if (!tail)
+        return std::string();
 
-                if (found_key)
-                {
-                    childName = it->second;
-                    break;
-                }
-            }
-        }
+    std::string pathStr = p->toString();
+
+    boost::unordered_map<std::string, std::string>::iterator found = namePrefixes_.find(pathStr);
+    if (found != namePrefixes_.end())
+        return found->second;
+
+    boost::unordered_map<std::string, std::string>::iterator it;
+    std::size_t found_bracket;
+    std::string childName(tail->getName()), childIndexStr, prefix;
 
-        // If the current child name was not found either on the map or top map, trim the name
-        // and write its name to the dump file
-        if ( !( found_key || found_top_key ) )
+    // Look for the array index, if any
+    if (*pathStr.rbegin() == ']')
+    {
+        found_bracket = pathStr.find_last_of('[');
+        childIndexStr = pathStr.substr(found_bracket + 1 , pathStr.length() - found_bracket - 2);
+    }
+
+    // Look for the key on the top map definition. If it is found, the prefix stops here.
+    if ( ( it = mapTop.find(childName) ) != mapTop.end() )
+    {
+        prefix = it->second + childIndexStr + ":";
+    }
+    else
+    {
+        // If key was not fount on top map, look for it on the map definition
+        if ( ( it = map.find(childName) ) != map.end() )
         {
+            childName = it->second;
+        }
+        else
+        {
+            // If the current child name was not found either on the map or top map, trim the name
+            // and write its name to the dump file
             keysNotFound->insert(childName);
             childName = childName.substr(0,DB_NAME_PATH_TRIM_SIZE);
         }
 
-        // Update the prefix up to now
-        resultPrefix = childName + childIndexStr + ":" + resultPrefix;
-
-        // If we found a key on the top map, stop the creation of the prefix
-        if ( found_top_key )
-            break;
-
         // Go up one level con the path and continue
-        pLocal->up();
-    }
+        Path parent = p->clone();
+        parent->up();
 
-    // Truncated string (if necessary) to satisfy the record max length and adding the index to the first element if any
-    // (record prefix length [ +1 from adding ':']) + (record name length) + (first element index length) + (record suffix length) <= record max length
-    resultPrefix = resultPrefix.substr(0, recordNameLenMax - (recordPrefix_.length() + 1) - DB_NAME_SUFFIX_LENGHT - firstElementIndexStr.length()) + firstElementIndexStr;
+        prefix = getNamePrefix(parent) + childName + childIndexStr + ":";
+    }
 
-    // Add the record name prefix and suffix
-    resultPrefix += ":" + suffix;
-    if ( recordPrefix_.length() > 0 )
-        resultPrefix = recordPrefix_ + ":" + resultPrefix;
+    namePrefixes_.insert( std::make_pair(pathStr, prefix) );
 
-    return resultPrefix;
+    return prefix;
 }
 
 /////////////////////////////////////////
@@ -1107,7 +1923,10 @@ void YCPSWASYN::loadConfiguration()
     try
     {
         YAML::Node conf(YAML::LoadFile(loadConfigFileName.c_str()));
-        entryCount = configPath->loadConfigFromYaml(conf);
+        {
+            YCPSWASYNConfigTransaction t(this, true);
+            entryCount = configPath->loadConfigFromYaml(conf);
+        }
 
         // Update status
         if (entryCount)
@@ -1175,7 +1994,10 @@ void YCPSWASYN::saveConfiguration()
     YAML::Node n;
     try
     {
-        entryCount = configPath->dumpConfigToYaml(n);
+        {
+            YCPSWASYNConfigTransaction t(this, false);
+            entryCount = configPath->dumpConfigToYaml(n);
+        }
 
         // Update status
         if (entryCount)
@@ -1240,24 +2062,21 @@ std::string YCPSWASYN::getEpicsScan(double scan)
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
-// int YCPSWASYN::autogenerateDatabase()                                           //
-// - Automatic generation of database from YAML definition                         //
-//                                                                                 //
+// void YCPSWASYN::discoverDatabase()                                              //
+// - Discovery phase of the automatic generation of database: read the maps, and   //
+//   the auto-generation cache if it can be used, or walk the hierarchy and attach //
+//   the interfaces of the registers found. No record nor parameter is created.    //
 /////////////////////////////////////////////////////////////////////////////////////
-int YCPSWASYN::autogenerateDatabase()
+void YCPSWASYN::discoverDatabase()
 {
-    // Create file names for the register and PV list dumps
-    std::string pre                  = debugFilePath + std::string(this->portName_) + "_";
-    if ( recordPrefix_.length() > 0 )
-    {
-        pre += string(recordPrefix_) + "_";
-    }
-    std::string pvDumpFileName       = pre + PV_DUMP_FILE_NAME;
+    YCPSWASYNPhaseTimer totalTimer(total_);
+    std::string pre                  = debugFilePrefix();
     std::string keysNotFoundFileName = pre + KEYS_NOT_FOUND_FILE_NAME;
 
     // Mapping files are only need when auto generation is used in mode 1
     if (autogenerationMode_ == 1)
     {
+        YCPSWASYNPhaseTimer timer(phases_[PHASE_MAP_FILES]);
         std::string mapFileName;
         std::string mapTopFileName;
 
@@ -1306,27 +2125,143 @@ int YCPSWASYN::autogenerateDatabase()
         keysNotFound = new YCPSWKeysNotFound (keysNotFoundFileName);
     }
 
-    // Open the PV list file
-    printf("Opening file \"%s\" for dumping PV list.\n", pvDumpFileName.c_str());
-    pvDumpFile  = new YCPSWASYNRAIIFile(pvDumpFileName, "w");
+    // Read the records from the auto-generation cache, if it was saved from the same
+    // hierarchy and settings
+    if ( ! generationCachePath.empty() )
+    {
+        std::string cachePre = generationCachePath + std::string(this->portName_) + "_";
+        if ( recordPrefix_.length() > 0 )
+            cachePre += recordPrefix_ + "_";
 
-    // Generate the EPICS database from the root path
-    printf("Generating EPICS database from yaml file...\n");
+        cacheFileName_ = cachePre + GEN_CACHE_FILE_NAME;
+        cacheKey_      = generationCacheKey(pre);
+
+        if ( ! cacheKey_.empty() )
+            cached_ = readGenerationCache(cacheFileName_, cacheKey_, cacheEntries_);
+    }
+
+    if (cached_)
+        return;
+
+    // Find the registers from the root path
+    printf("Discovering the registers of port %s from yaml file...\n", this->portName_);
+    generateDB_ = new YCPSWASYNGenerateDB( pre, this );
     try
     {
-        YCPSWASYNGenerateDB generateDB( pre, this );
+        generateDB_->yamlWrite( "recordPrefix: %s\nroot:\n", recordPrefix_.c_str() );
+        generateDB_->pushYamlIndent();
+        generateDB_->walk( p_ );
+        generateDB_->popYamlIndent();
 
-        generateDB.yamlFile.write( "recordPrefix: %s\nroot:\n", recordPrefix_.c_str() );
-        generateDB.pushYamlIndent();
-        generateDB.genereate( p_ );
-        generateDB.popYamlIndent();
+        if ( ! pathFilters.empty() )
+            printf("Subtrees and registers left out by the path filters: %zu\n", generateDB_->filteredCount());
     }
     catch (CPSWError &e)
     {
         fprintf(stderr, "CPSW Error (during DB generation, port: %s): %s\n", this->portName_, e.getInfo().c_str());
+        delete generateDB_;
+        generateDB_ = NULL;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// int YCPSWASYN::autogenerateDatabase()                                           //
+// - Automatic generation of database from YAML definition. The records of the     //
+//   registers found by discoverDatabase are created.                              //
+/////////////////////////////////////////////////////////////////////////////////////
+int YCPSWASYN::autogenerateDatabase()
+{
+    // Create file names for the register and PV list dumps
+    std::string pre                  = debugFilePrefix();
+    std::string pvDumpFileName       = pre + PV_DUMP_FILE_NAME;
+    std::string keysNotFoundFileName = pre + KEYS_NOT_FOUND_FILE_NAME;
+
+    // Open the PV list file
+    printf("Opening file \"%s\" for dumping PV list.\n", pvDumpFileName.c_str());
+    pvDumpFile  = new YCPSWASYNRAIIFile(pvDumpFileName, "w");
+
+    // Write the records to one database, which is loaded once all of them are created
+    std::string dbBatchFileName = pre + RECORDS_DB_FILE_NAME;
+    if (batchLoad)
+    {
+        dbBatchFile = new YCPSWASYNRAIIFile(dbBatchFileName, "w");
+
+        if ( ( ! dbBatchFile->f() ) || macCreateHandle(&dbBatchMacros_, NULL) )
+        {
+            fprintf(stderr, "Error: The records will be loaded one at a time\n");
+            delete dbBatchFile;
+            dbBatchFile = NULL;
+        }
+        else
+        {
+            // Undefined macros are reported by dbLoadRecords, when the record is loaded on its own
+            macSuppressWarning(dbBatchMacros_, 1);
+        }
     }
 
-    printf("Generation of EPICS database from yaml file Done!.\n");
+    // Load the records read from the auto-generation cache
+    if (cached_)
+    {
+        loadGenerationCache(cacheEntries_);
+        std::vector<YCPSWASYNCacheEntry>().swap(cacheEntries_);
+    }
+    else
+    {
+        bool generated = false;
+
+        // Save the generation on a new cache file. It replaces the current one once the generation succeeds.
+        if ( ! cacheKey_.empty() )
+        {
+            genCacheFile = new YCPSWASYNRAIIFile(cacheFileName_ + ".new", "w");
+            genCacheFile->write("key %s\n", cacheKey_.c_str());
+        }
+
+        // Generate the EPICS database from the registers found
+        printf("Generating EPICS database from yaml file...\n");
+        if (generateDB_)
+        {
+            try
+            {
+                generateDB_->createRecords();
+                generated = true;
+            }
+            catch (CPSWError &e)
+            {
+                fprintf(stderr, "CPSW Error (during DB generation, port: %s): %s\n", this->portName_, e.getInfo().c_str());
+            }
+
+            // The register dumps are written when it is deleted
+            delete generateDB_;
+            generateDB_ = NULL;
+        }
+
+        printf("Generation of EPICS database from yaml file Done!.\n");
+
+        if (genCacheFile)
+        {
+            bool saved = generated && genCacheFile->f();
+
+            if ( saved && keysNotFound )
+            {
+                const std::set<std::string>& keys = keysNotFound->elements();
+                for (std::set<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+                    genCacheFile->write("K\t%s\n", escapeCacheField(*it).c_str());
+            }
+
+            delete genCacheFile;
+            genCacheFile = NULL;
+
+            if ( saved && ( 0 == rename( (cacheFileName_ + ".new").c_str(), cacheFileName_.c_str() ) ) )
+            {
+                printf("Auto-generation cache saved to \"%s\"\n", cacheFileName_.c_str());
+            }
+            else
+            {
+                fprintf(stderr, "Error: Auto-generation cache \"%s\" not saved\n", cacheFileName_.c_str());
+                remove( (cacheFileName_ + ".new").c_str() );
+            }
+        }
+    }
 
     if (autogenerationMode_ == 1)
     {
@@ -1339,113 +2274,439 @@ int YCPSWASYN::autogenerateDatabase()
     // Close the PV list file
     delete pvDumpFile;
 
+    // Load the auto-generated database
+    if (dbBatchFile)
+    {
+        delete dbBatchFile;
+        dbBatchFile = NULL;
+        macDeleteHandle(dbBatchMacros_);
+        dbBatchMacros_ = NULL;
+        templates_.clear();
+        std::vector<char>().swap(dbBatchBuffer_);
+
+        printf("Loading the records from \"%s\"...\n", dbBatchFileName.c_str());
+        YCPSWASYNPhaseTimer timer(phases_[PHASE_DB_LOAD]);
+        dbLoadRecords(dbBatchFileName.c_str(), NULL);
+    }
+
+    // The record names are not generated again
+    namePrefixes_.clear();
+    hashedNames_.clear();
+
     // Print counters
     printf("Total number of record loaded = %ld\n", recordCount);
     printf("Total number of register processed:\n");
-    printf("  - ScalVal_RO   = %ld\n", nRO - nRW);
-    printf("  - ScalVal      = %ld\n", nRW);
-    printf("  - DoubleVal_RO = %ld\n", nFO - nFW);
-    printf("  - DoubleVal    = %ld\n", nFW);
-    printf("  - Command      = %ld\n", nCMD);
-    printf("  - Stream       = %ld\n", nSTM);
+    // Registers are counted by the shard they were added to
+    long tRO = 0, tRW = 0, tFO = 0, tFW = 0, tCMD = 0, tSTM = 0;
+    for (std::size_t i = 0; i < shards_.size(); ++i)
+    {
+        tRO  += shards_[i]->nRO;
+        tRW  += shards_[i]->nRW;
+        tFO  += shards_[i]->nFO;
+        tFW  += shards_[i]->nFW;
+        tCMD += shards_[i]->nCMD;
+        tSTM += shards_[i]->nSTM;
+    }
+    printf("  - ScalVal_RO   = %ld\n", tRO - tRW);
+    printf("  - ScalVal      = %ld\n", tRW);
+    printf("  - DoubleVal_RO = %ld\n", tFO - tFW);
+    printf("  - DoubleVal    = %ld\n", tFW);
+    printf("  - Command      = %ld\n", tCMD);
+    printf("  - Stream       = %ld\n", tSTM);
     printf("\n");
 
     return 0;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// void YCPSWASYN::addParameter(const T& reg, const std::string& paramName, const asynParamType& paramType) //
-// - Creates a parameter for the given register an add its pointer to its list                              //
-//                                                                                                          //
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename T>
-void YCPSWASYN::addParameter(const T& reg, const std::string& paramName, const asynParamType& paramType)
+/////////////////////////////////////////////////////////////////////////////////////
+// std::string YCPSWASYN::generationCacheKey(const std::string& pre)               //
+// - Key of the auto-generation cache. It is the hash of the YAML hierarchy, dumped //
+//   to a file by CPSW, the substitution maps, and the settings used to name the    //
+//   records and to assign them to the shards.                                     //
+/////////////////////////////////////////////////////////////////////////////////////
+std::string YCPSWASYN::generationCacheKey(const std::string& pre)
 {
-    int paramIndex;
-
-    createParam(getRegType(reg), paramName.c_str(), paramType, &paramIndex);
-    pushParameter(reg, paramIndex);
-}
+    std::string   hierarchyFileName = pre + HIERARCHY_DUMP_FILE_NAME;
+    std::ifstream hierarchyFile;
+    std::string   line;
+    stringstream  settings;
+    sha1          hasher;
+    char          mdstr[SHA1_HEX_SIZE];
 
-template <>
-void YCPSWASYN::addParameter(const Stream& reg, const std::string& paramName, const asynParamType& paramType)
-{
-    int paramIndex32, paramIndex16;
-    std::string paramName16 = paramName + string(":16");
+    // Only the entries read from the cache are counted
+    YCPSWASYNPhaseTimer timer(phases_[PHASE_CACHE]);
+    timer.setCount(0);
 
-    createParam(DEV_STM, paramName.c_str(), paramType, &paramIndex32);
-    createParam(DEV_STM, paramName16.c_str(), paramType, &paramIndex16);
+    try
+    {
+        IYamlSupport::dumpYamlFile( p_->origin(), hierarchyFileName.c_str(), p_->origin()->getName() );
+    }
+    catch (CPSWError &e)
+    {
+        fprintf(stderr, "CPSW Error (dumping the hierarchy of port %s): %s\n", this->portName_, e.getInfo().c_str());
+        fprintf(stderr, "The auto-generation cache will not be used\n");
+        return std::string();
+    }
 
-    // Create Acquisition Thread
-    asynStatus status;
-    ThreadArgs *arglist = new ThreadArgs();
-    arglist->pPvt = this;
-    arglist->stm = reg;
-    arglist->param16index = paramIndex16;
-    arglist->param32index = paramIndex32;
+    hierarchyFile.open(hierarchyFileName.c_str());
+    if (!hierarchyFile.is_open())
+    {
+        fprintf(stderr, "Error: Unable to read the hierarchy dump \"%s\"\n", hierarchyFileName.c_str());
+        fprintf(stderr, "The auto-generation cache will not be used\n");
+        return std::string();
+    }
 
-    status = (asynStatus)(epicsThreadCreate("Stream", epicsThreadPriorityLow,
-            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)streamTaskC, arglist) == NULL);
+    hasher.add(GEN_CACHE_VERSION "\n");
 
-    if (status)
+    while (std::getline(hierarchyFile, line))
     {
-        printf("epicsThreadCreate failure for parameter %s\n", paramName.c_str());
-        delete arglist;
-        return;
+        hasher.add(line.c_str());
+        hasher.add('\n');
     }
-    else
-        printf("epicsThreadCreate successfully for parameters %s and %s\n", paramName.c_str(), paramName16.c_str());
 
-}
+    settings << p_->toString()      << "\n";
+    settings << recordPrefix_       << "\n";
+    settings << recordNameLenMax    << "\n";
+    settings << autogenerationMode_ << "\n";
+    settings << defaultScan         << "\n";
+    settings << shardCount          << " " << shardKeyMode << "\n";
 
-/////////////////////////////////////////////////////////////////////////////////////////
-// void YCPSWASYN::createRegisterParameter(const T& reg, const std::string& paramName) //
-// - Creates a asyn parameter for the given register                                   //
-//                                                                                     //
-/////////////////////////////////////////////////////////////////////////////////////////
-template <typename T>
-void YCPSWASYN::createRegisterParameter(const T& reg, const std::string& paramName)
-{
-    asynParamType paramType;
+    for (std::size_t i = 0; i < pathFilters.size(); ++i)
+        settings << ( pathFilters[i].include ? "include " : "exclude " ) << pathFilters[i].pattern << "\n";
 
-    // Get the register information
-    int  nElements = reg->getNelms();
-    Enum isEnum    = reg->getEnum();
+    // The maps are hashed in key order
+    std::map<std::string, std::string> sortedMapTop(mapTop.begin(), mapTop.end());
+    std::map<std::string, std::string> sortedMap(map.begin(), map.end());
 
-    if (nElements == 1)
+    for (std::map<std::string, std::string>::iterator it = sortedMapTop.begin(); it != sortedMapTop.end(); ++it)
+        settings << it->first << " " << it->second << "\n";
+    settings << "\n";
+    for (std::map<std::string, std::string>::iterator it = sortedMap.begin(); it != sortedMap.end(); ++it)
+        settings << it->first << " " << it->second << "\n";
+
+    hasher.add(settings.str().c_str());
+    hasher.finalize().print_hex(mdstr);
+
+    return std::string(mdstr);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::readGenerationCache(const std::string& fileName,                //
+//                                     const std::string& key,                     //
+//                                     std::vector<YCPSWASYNCacheEntry>& entries)  //
+// void YCPSWASYN::loadGenerationCache(                                            //
+//                                const std::vector<YCPSWASYNCacheEntry>& entries) //
+// - Load the records saved on the auto-generation cache. All entries are read,    //
+//   and their CPSW interfaces created, before the first record is loaded; if any  //
+//   of them fails the cache is not used, and the database is generated instead.   //
+/////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::readGenerationCache(const std::string& fileName, const std::string& key, std::vector<YCPSWASYNCacheEntry>& cached)
+{
+    YCPSWASYNPhaseTimer              timer(phases_[PHASE_CACHE]);
+    std::ifstream                    cacheFile;
+    std::vector<YCPSWASYNCacheEntry> entries;
+    std::string                      line;
+    std::size_t                      lineNumber = 1;
+
+    cacheFile.open(fileName.c_str());
+    if (!cacheFile.is_open())
     {
-        if ((isEnum) && (isEnum->getNelms() < DB_MBBX_NELEM_MAX))
-            paramType = asynParamUInt32Digital;
-        else
-            paramType =  asynParamInt32;
+        printf("Auto-generation cache \"%s\" not found\n", fileName.c_str());
+        return false;
     }
-    else
+
+    // The first line has the key the cache was saved with
+    if ( ( ! std::getline(cacheFile, line) ) || ( line != "key " + key ) )
     {
-        paramType = asynParamInt32Array;
+        printf("Auto-generation cache \"%s\" was saved from a different hierarchy or settings\n", fileName.c_str());
+        return false;
     }
 
-    addParameter(reg, paramName, paramType);
-}
+    printf("Reading the auto-generation cache \"%s\"...\n", fileName.c_str());
 
-template<>
-void YCPSWASYN::createRegisterParameter(const Command& reg, const std::string& paramName)
-{
-    addParameter(reg, paramName, asynParamUInt32Digital);
+    try
+    {
+        while (std::getline(cacheFile, line))
+        {
+            std::vector<std::string> fields;
+            std::size_t              start = 0, end;
+            YCPSWASYNCacheEntry      e;
+
+            ++lineNumber;
+
+            do
+            {
+                end = line.find('\t', start);
+                fields.push_back(unescapeCacheField(line.substr(start, end - start)));
+                start = end + 1;
+            }
+            while (end != std::string::npos);
+
+            e.type = fields[0].empty() ? '\0' : fields[0][0];
+
+            if ( ( e.type == 'K' ) && ( fields.size() == 2 ) )
+            {
+                e.name = fields[1];
+            }
+            else if ( ( ( e.type == 'S' ) || ( e.type == 'G' ) || ( e.type == 'T' ) ) && ( fields.size() == 2 ) )
+            {
+                e.p = p_->findByName(fields[1].c_str());
+
+                if (e.type == 'G')
+                    e.ifs.ro = IScalVal_RO::create(e.p);
+                else if (e.type == 'T')
+                    e.ifs.stm = IStream::create(e.p);
+            }
+            else if ( ( e.type == 'R' ) && ( fields.size() == 10 ) )
+            {
+                e.regType         = atoi(fields[1].c_str());
+                e.rp.paramType    = static_cast<asynParamType>(atoi(fields[2].c_str()));
+                e.element         = atoi(fields[3].c_str());
+                e.p               = p_->findByName(fields[4].c_str());
+                e.rp.recTemplate  = fields[5];
+                e.rp.recName      = fields[6];
+                e.rp.paramName    = fields[7];
+                e.rp.recDesc      = fields[8];
+                e.dbParams        = fields[9];
+
+                // The interfaces are created on first access, if requested
+                if ( lazyInterfaces && ( e.regType >= DEV_REG_RO ) && ( e.regType <= DEV_CMD ) )
+                {
+                    entries.push_back(e);
+                    continue;
+                }
+
+                switch (e.regType)
+                {
+                    case DEV_REG_RO:
+                        e.ifs.ro  = IScalVal_RO::create(e.p);
+                        break;
+                    case DEV_REG_RW:
+                        e.ifs.rw  = IScalVal::create(e.p);
+                        break;
+                    case DEV_FLOAT_RO:
+                        e.ifs.fo  = IDoubleVal_RO::create(e.p);
+                        break;
+                    case DEV_FLOAT_RW:
+                        e.ifs.fw  = IDoubleVal::create(e.p);
+                        break;
+                    case DEV_CMD:
+                        e.ifs.cmd = ICommand::create(e.p);
+                        break;
+                    case DEV_STM:
+                        // The stream interface is created with the stream thread entry
+                        break;
+                    default:
+                        printf("Invalid register type on line %zu of the auto-generation cache\n", lineNumber);
+                        return false;
+                }
+            }
+            else
+            {
+                printf("Invalid entry on line %zu of the auto-generation cache\n", lineNumber);
+                return false;
+            }
+
+            entries.push_back(e);
+        }
+    }
+    catch (CPSWError &e)
+    {
+        printf("CPSW Error on line %zu of the auto-generation cache: %s\n", lineNumber, e.getInfo().c_str());
+        return false;
+    }
+
+    timer.setCount(entries.size());
+    cached.swap(entries);
+
+    return true;
+}
+
+void YCPSWASYN::loadGenerationCache(const std::vector<YCPSWASYNCacheEntry>& entries)
+{
+    printf("Loading EPICS database from the auto-generation cache...\n");
+
+    // Replay the entries, in the order they were saved
+    YCPSWASYNFieldGroup *group = NULL;
+    std::vector<int>     streamParams;
+    int                  paramIndex;
+
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        const YCPSWASYNCacheEntry& e = entries[i];
+
+        switch (e.type)
+        {
+            case 'K':
+                if (keysNotFound)
+                    keysNotFound->insert(e.name);
+                break;
+
+            case 'S':
+                currentShard_ = selectShard(e.p);
+                group         = NULL;
+                streamParams.clear();
+                break;
+
+            case 'G':
+                group = currentShard_->createFieldGroup(e.ifs.ro, e.p);
+                break;
+
+            case 'T':
+                // The 32-bit stream record is loaded first
+                if (streamParams.size() == 2)
+                    startStream(e.ifs.stm, e.p, streamParams[1], streamParams[0]);
+                streamParams.clear();
+                break;
+
+            case 'R':
+                paramIndex = LoadRecord(e.regType, e.rp, e.dbParams, e.p, e.element);
+
+                if ( lazyInterfaces && ( e.regType <= DEV_CMD ) )
+                {
+                    currentShard_->deferParameter(e.regType, paramIndex, e.p);
+                    if ( group && ( e.regType == DEV_REG_RO ) && ( e.element >= 0 ) )
+                        currentShard_->addToFieldGroup(group, paramIndex, e.element);
+                    break;
+                }
+
+                switch (e.regType)
+                {
+                    case DEV_REG_RO:
+                        currentShard_->pushParameter(e.ifs.ro, paramIndex, e.p);
+                        if ( group && ( e.element >= 0 ) )
+                            currentShard_->addToFieldGroup(group, paramIndex, e.element);
+                        break;
+                    case DEV_REG_RW:
+                        currentShard_->pushParameter(e.ifs.rw, paramIndex, e.p);
+                        break;
+                    case DEV_FLOAT_RO:
+                        currentShard_->pushParameter(e.ifs.fo, paramIndex, e.p);
+                        break;
+                    case DEV_FLOAT_RW:
+                        currentShard_->pushParameter(e.ifs.fw, paramIndex, e.p);
+                        break;
+                    case DEV_CMD:
+                        currentShard_->pushParameter(e.ifs.cmd, paramIndex, e.p);
+                        break;
+                    case DEV_STM:
+                        streamParams.push_back(paramIndex);
+                        break;
+                }
+                break;
+        }
+    }
+
+    printf("Loading EPICS database from the auto-generation cache Done!.\n");
+}
+
+std::string YCPSWASYN::relativePathName(const Path& p)
+{
+    std::string name = p->toString();
+    std::string root = p_->toString();
+
+    if (0 == name.compare(0, root.size(), root))
+        name = name.substr(root.size());
+
+    std::size_t first = name.find_first_not_of('/');
+
+    return ( first == std::string::npos ) ? std::string() : name.substr(first);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::addParameter(const T& reg, const std::string& paramName,                                 //
+//                              const asynParamType& paramType, const Path& p)                              //
+// - Creates a parameter for the given register an add its pointer to its list                              //
+//                                                                                                          //
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void YCPSWASYN::addParameter(const T& reg, const std::string& paramName, const asynParamType& paramType, const Path& p)
+{
+    int paramIndex;
+
+    createParam(getRegType(reg), paramName.c_str(), paramType, &paramIndex);
+    pushParameter(reg, paramIndex, p);
+}
+
+template <>
+void YCPSWASYN::addParameter(const Stream& reg, const std::string& paramName, const asynParamType& paramType, const Path& p)
+{
+    int paramIndex32, paramIndex16;
+    std::string paramName16 = paramName + string(":16");
+
+    createParam(DEV_STM, paramName.c_str(), paramType, &paramIndex32);
+    createParam(DEV_STM, paramName16.c_str(), paramType, &paramIndex16);
+
+    // Create Acquisition Thread
+    asynStatus status;
+    ThreadArgs *arglist = new ThreadArgs();
+    arglist->pPvt = this;
+    arglist->stm = reg;
+    arglist->param16index = paramIndex16;
+    arglist->param32index = paramIndex32;
+
+    status = (asynStatus)(epicsThreadCreate("Stream", epicsThreadPriorityLow,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)streamTaskC, arglist) == NULL);
+
+    if (status)
+    {
+        printf("epicsThreadCreate failure for parameter %s\n", paramName.c_str());
+        delete arglist;
+        return;
+    }
+    else
+        printf("epicsThreadCreate successfully for parameters %s and %s\n", paramName.c_str(), paramName16.c_str());
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::createRegisterParameter(const T& reg, const std::string& paramName, //
+//                                         const Path& p)                              //
+// - Creates a asyn parameter for the given register                                   //
+//                                                                                     //
+/////////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void YCPSWASYN::createRegisterParameter(const T& reg, const std::string& paramName, const Path& p)
+{
+    asynParamType paramType;
+
+    // Get the register information
+    int  nElements = reg->getNelms();
+    Enum isEnum    = reg->getEnum();
+
+    if (nElements == 1)
+    {
+        if ((isEnum) && (isEnum->getNelms() < DB_MBBX_NELEM_MAX))
+            paramType = asynParamUInt32Digital;
+        else
+            paramType =  asynParamInt32;
+    }
+    else
+        paramType = arrayParamType(reg->getSizeBits());
+
+    addParameter(reg, paramName, paramType, p);
+}
+
+template<>
+void YCPSWASYN::createRegisterParameter(const Command& reg, const std::string& paramName, const Path& p)
+{
+    addParameter(reg, paramName, asynParamUInt32Digital, p);
 }
 
 template<>
-void YCPSWASYN::createRegisterParameter(const Stream& reg, const std::string& paramName)
+void YCPSWASYN::createRegisterParameter(const Stream& reg, const std::string& paramName, const Path& p)
 {
-    addParameter(reg, paramName, asynParamInt32);
+    addParameter(reg, paramName, asynParamInt32, p);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-// void YCPSWASYN::createRegisterParameterFloat(const T& reg, const std::string& paramName) //
+// void YCPSWASYN::createRegisterParameterFloat(const T& reg, const std::string& paramName, //
+//                                              const Path& p)                              //
 // - Creates a asyn parameter for the given float register                                  //
 //                                                                                          //
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename T>
-void YCPSWASYN::createRegisterParameterFloat(const T& reg, const std::string& paramName)
+void YCPSWASYN::createRegisterParameterFloat(const T& reg, const std::string& paramName, const Path& p)
 {
     asynParamType paramType;
 
@@ -1457,7 +2718,7 @@ void YCPSWASYN::createRegisterParameterFloat(const T& reg, const std::string& pa
     else
         paramType = asynParamFloat64Array;
 
-    addParameter(reg, paramName, paramType);
+    addParameter(reg, paramName, paramType, p);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -1469,6 +2730,7 @@ int YCPSWASYN::loadDBFromFile(const char* dictionary)
 {
     if (dictionary && dictionary[0] != '\0')
     {
+        YCPSWASYNPhaseTimer timer(phases_[PHASE_DICTIONARY]);
         printf("Opening dictionary \"%s\"... ", dictionary);
         std::ifstream dictFile;
         dictFile.open(dictionary);
@@ -1492,6 +2754,20 @@ int YCPSWASYN::loadDBFromFile(const char* dictionary)
                 if (regPath[0] == '#')
                     continue;
 
+                // Find the register on the hierarchy
+                Path regP;
+                try
+                {
+                    regP = p_->findByName(regPath.c_str());
+                }
+                catch (CPSWError &e) {}
+
+                if (!regP)
+                {
+                    printf("ERROR: Register %s not found\n", regPath.c_str());
+                    continue;
+                }
+
                 // Check first if it is a stream
                 size_t found_key = regPath.find(STREAM_KEY);
                 if ((found_key != std::string::npos) && (isdigit(regPath[found_key + strlen(STREAM_KEY)])))
@@ -1500,14 +2776,14 @@ int YCPSWASYN::loadDBFromFile(const char* dictionary)
 
                     try
                     {
-                        stm_aux = IStream::create(p_->findByName(regPath.c_str()));
+                        stm_aux = IStream::create(regP);
                     }
                     catch (CPSWError &e) {}
 
                     if (stm_aux)
                     {
                         printf("Stream interface created for %s\n", regPath.c_str());
-                        createRegisterParameter(stm_aux, paramName);
+                        createRegisterParameter(stm_aux, paramName, regP);
                     }
                     else
                     {
@@ -1518,68 +2794,52 @@ int YCPSWASYN::loadDBFromFile(const char* dictionary)
                 // Now try the other kind of interfaces
                 else
                 {
-                    ScalVal         rw_aux;
-                    ScalVal_RO      ro_aux;
-                    Command         cmd_aux;
-                    DoubleVal       fw_aux;
-                    DoubleVal_RO    fo_aux;
+                    YCPSWASYNInterfaces ifs;
 
-                    try
-                    {
-                        ro_aux = IScalVal_RO::create(p_->findByName(regPath.c_str()));
-                        rw_aux = IScalVal::create(p_->findByName(regPath.c_str()));
-                    }
-                    catch (CPSWError &e) {}
+                    createInterfaces(regP, ifs);
+
+                    ScalVal         rw_aux  = ifs.rw;
+                    ScalVal_RO      ro_aux  = ifs.ro;
+                    Command         cmd_aux = ifs.cmd;
+                    DoubleVal       fw_aux  = ifs.fw;
+                    DoubleVal_RO    fo_aux  = ifs.fo;
 
                     if (rw_aux)
                     {
                         printf("ScalVal interface created for %s\n", regPath.c_str());
-                        createRegisterParameter(rw_aux, paramName);
+                        createRegisterParameter(rw_aux, paramName, regP);
 
                         // This was added to ensure RW array registers can be read back                                        
                         if (rw_aux -> getNelms() > 1 && ro_aux)
                         {
                             printf("ScalVal_RO interface created for %s\n", regPath.c_str());
-                            createRegisterParameter(ro_aux, paramName);
+                            createRegisterParameter(ro_aux, paramName, regP);
                         }
                     }
                     else if (ro_aux)
                     {
                         printf("ScalVal_RO interface created for %s\n", regPath.c_str());
-                        createRegisterParameter(ro_aux, paramName);
+                        createRegisterParameter(ro_aux, paramName, regP);
                     }
                     else
                     {
-                        try
-                        {
-                            fo_aux = IDoubleVal_RO::create(p_->findByName(regPath.c_str()));
-                            fw_aux = IDoubleVal::create(p_->findByName(regPath.c_str()));
-                        }
-                        catch (CPSWError &e) {}
-
                         if (fw_aux)
                         {
                             printf("DoubleVal interface created for %s\n", regPath.c_str());
-                            createRegisterParameterFloat(fw_aux, paramName);
+                            createRegisterParameterFloat(fw_aux, paramName, regP);
 
                         }
                         else if (fo_aux)
                         {
                             printf("DoubleVal_RO interface created for %s\n", regPath.c_str());
-                            createRegisterParameterFloat(fo_aux, paramName);
+                            createRegisterParameterFloat(fo_aux, paramName, regP);
                         }
                         else
                         {
-                            try
-                            {
-                                cmd_aux = ICommand::create(p_->findByName(regPath.c_str()));
-                            }
-                            catch (CPSWError &e) {}
-
                             if (cmd_aux)
                             {
                                 printf("Command interface created for %s\n", regPath.c_str());
-                                createRegisterParameter(cmd_aux, paramName);
+                                createRegisterParameter(cmd_aux, paramName, regP);
                             }
                             else
                             {
@@ -1603,921 +2863,3991 @@ int YCPSWASYN::loadDBFromFile(const char* dictionary)
     return 0;
 }
 
-//////////////////////////////////////////////
-// + Methods overridden from asynPortDriver //
-//////////////////////////////////////////////
-asynStatus YCPSWASYN::writeInt32(asynUser *pasynUser, epicsInt32 value)
+////////////////////////////////////////////////////////////////////////////////////
+// asynStatus YCPSWASYN::updateIntegerParam(int list, int index, int value)       //
+// asynStatus YCPSWASYN::updateDoubleParam(int list, int index, double value)     //
+// asynStatus YCPSWASYN::updateUIntDigitalParam(int list, int index,              //
+//                                              epicsUInt32 value,                //
+//                                              epicsUInt32 mask)                 //
+//                                                                                //
+// - Update a parameter with a value read from a register. Interrupt callbacks    //
+//   are done only when the value or the status changed, and only for that        //
+//   parameter. A failed asynchronous access leaves the parameter in error.       //
+////////////////////////////////////////////////////////////////////////////////////
+asynStatus YCPSWASYN::updateIntegerParam(int list, int index, int value)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
-
-    this->getAddress(pasynUser, &addr);
+    int        oldValue;
+    asynStatus oldStatus;
+    asynStatus status;
 
-    static const char *functionName = "writeInt32";
+    if ( ( getIntegerParam(list, index, &oldValue) == asynSuccess ) && ( oldValue == value ) &&
+         ( getParamStatus(list, index, &oldStatus) == asynSuccess ) && ( oldStatus == asynSuccess ) )
+        return asynSuccess;
 
-    this->getAddress(pasynUser, &addr);
+    status = setIntegerParam(list, index, value);
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    // This parameter is the only one flagged as changed on its list
+    if (status == asynSuccess)
     {
-        try
-        {
-            if (addr == DEV_REG_RW)
-                rw[function]->setVal((uint32_t*)&value, 1);
-            else if (addr == DEV_CONFIG)
-            {
-                if (function == saveConfigValue_)
-                    saveConfiguration();
-                else if (function == loadConfigValue_)
-                    loadConfiguration();
-                else
-                    status = asynPortDriver::writeInt32(pasynUser, value);
-            }
-            else
-                status = asynPortDriver::writeInt32(pasynUser, value);
-        }
-        catch (CPSWError &e)
-        {
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
-        }
+        setParamStatus(list, index, asynSuccess);
+        status = callParamCallbacks(list, list);
+    }
+
+    return status;
+}
 
+asynStatus YCPSWASYN::updateDoubleParam(int list, int index, double value)
+{
+    double     oldValue;
+    asynStatus oldStatus;
+    asynStatus status;
 
+    if ( ( getDoubleParam(list, index, &oldValue) == asynSuccess ) && ( oldValue == value ) &&
+         ( getParamStatus(list, index, &oldStatus) == asynSuccess ) && ( oldStatus == asynSuccess ) )
+        return asynSuccess;
 
-        if (status == 0)
-        {
-            asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                        "%s:%s(%d), port %s parameter %s set to %d\n", \
-                        driverName_, functionName, function, this->portName, name, value);
-        }
-        else
-        {
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                        "%s:%s(%d), port %s ERROR setting parameter %s to %d (status = %d)\n", \
-                        driverName_, functionName, function, this->portName, name, value, status);
-        }
+    status = setDoubleParam(list, index, value);
 
+    if (status == asynSuccess)
+    {
+        setParamStatus(list, index, asynSuccess);
+        status = callParamCallbacks(list, list);
     }
-    else
-        status = asynPortDriver::writeInt32(pasynUser, value);
-
-    callParamCallbacks(addr);
-    unlock();
 
-    return (status==0) ? asynSuccess : asynError;
+    return status;
 }
 
-asynStatus YCPSWASYN::readInt32(asynUser *pasynUser, epicsInt32 *value)
+asynStatus YCPSWASYN::updateUIntDigitalParam(int list, int index, epicsUInt32 value, epicsUInt32 mask)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    uint32_t u32;
-    const char *name;
+    epicsUInt32 oldValue;
+    asynStatus  oldStatus;
+    asynStatus  status;
 
-    this->getAddress(pasynUser, &addr);
+    if ( ( getUIntDigitalParam(list, index, &oldValue, mask) == asynSuccess ) && ( oldValue == ( value & mask ) ) &&
+         ( getParamStatus(list, index, &oldStatus) == asynSuccess ) && ( oldStatus == asynSuccess ) )
+        return asynSuccess;
 
-    static const char *functionName = "readInt32";
+    status = setUIntDigitalParam(list, index, value, mask);
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    if (status == asynSuccess)
     {
-        try
-        {
-            if (addr == DEV_REG_RO)
-            {
-                ro[function]->getVal(&u32, 1);
-                *value = (epicsInt32)u32;
-                status = setIntegerParam(addr, function, (int)u32);
-            }
-            else if (addr == DEV_REG_RW)
-            {
-                rw[function]->getVal(&u32, 1);
-                *value = (epicsInt32)u32;
-                status = setIntegerParam(addr, function, (int)u32);
-            }
-            else if (addr == DEV_CONFIG)
-            {
-                status = getIntegerParam(addr, function, (int*)value);
-            }
-            else
-                status = asynPortDriver::readInt32(pasynUser, value);
-        }
-        catch (CPSWError &e)
+        setParamStatus(list, index, asynSuccess);
+        status = callParamCallbacks(list, list);
+    }
+
+    return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::queueRegisterJob(YCPSWASYNRegisterJob *job,                    //
+//                                  YCPSWASYNDevice *dev, bool *readPending);     //
+//                                                                                //
+// - Hand a register access to the worker pool. Accesses to the same device are   //
+//   run in order by the same worker. A read is dropped if another read of the    //
+//   same register is still in flight. Called with the port lock taken.           //
+////////////////////////////////////////////////////////////////////////////////////
+// Key of the worker running the jobs of a device
+static size_t workerKey(const YCPSWASYNDevice *dev)
+{
+    return reinterpret_cast<size_t>(dev) / sizeof(YCPSWASYNDevice);
+}
+
+void YCPSWASYN::queueRegisterJob(YCPSWASYNRegisterJob *job, YCPSWASYNDevice *dev, bool *readPending)
+{
+    if (readPending)
+    {
+        if (*readPending)
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            delete job;
+            return;
         }
+
+        *readPending = true;
+        job->readPending = readPending;
     }
-    else
-        status = asynPortDriver::readInt32(pasynUser, value);
 
-    if (status == 0)
+    workers_->queue(job, workerKey(dev));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::initRecordRequest(YCPSWASYNRecordRequest *req,                 //
+//                                   const char *param);                          //
+//                                                                                //
+// - Attach a record of the asynchronous device support to the register of the   //
+//   parameter with the given name, on the parameter list req->addr. The access   //
+//   type (req->type) must match the register: writes are only done on RW         //
+//   registers, and the parameter must have the type of the interface.            //
+////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::initRecordRequest(YCPSWASYNRecordRequest *req, const char *param)
+{
+    // Parameter type of each access (see registerJobList)
+    static const asynParamType paramTypes[] =
     {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s read %d from parameter %s\n", \
-                    driverName_, functionName, function, this->portName, *value, name);
-    }
-    else
+        asynParamInt32, asynParamUInt32Digital, asynParamFloat64,
+        asynParamInt32, asynParamUInt32Digital, asynParamFloat64
+    };
+
+    asynParamType type;
+    bool          found = false;
+
+    if ( ( ! workers_ ) || ( req->type < JOB_READ_INT32 ) || ( req->type > JOB_WRITE_FLOAT64 ) ||
+         ( req->addr < 0 ) || ( req->addr >= MAX_SIGNALS ) )
+        return false;
+
+    lock();
+
+    if ( ( findParam(req->addr, param, &req->function) == asynSuccess ) &&
+         ( ! windowParams_[req->addr].count(req->function) ) &&
+         ( getParamType(req->addr, req->function, &type) == asynSuccess ) && ( type == paramTypes[req->type] ) )
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, status);
+        bool write = ( req->type >= JOB_WRITE_INT32 );
+
+        if (req->addr == DEV_REG_RO)
+            found = ( ! write ) && ro.contains(req->function);
+        else if (req->addr == DEV_REG_RW)
+            found = rw.contains(req->function);
+        else if (req->addr == DEV_FLOAT_RO)
+            found = ( ! write ) && fo.contains(req->function);
+        else if (req->addr == DEV_FLOAT_RW)
+            found = fw.contains(req->function);
     }
 
-    callParamCallbacks(addr);
     unlock();
 
-    return (status==0) ? asynSuccess : asynError;
-}
+    if (found)
+        req->drv = this;
 
+    return found;
+}
 
-asynStatus YCPSWASYN::writeFloat64(asynUser *pasynUser, epicsFloat64 value)
+////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::getRecordValue(YCPSWASYNRecordRequest *req);                   //
+//                                                                                //
+// - Get the value the parameter of a record holds, e.g. after the startup       //
+//   prefetch, on req->u32 or req->f64. It is the initial value of the output     //
+//   records. Returns false if the parameter has no value yet.                    //
+////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::getRecordValue(YCPSWASYNRecordRequest *req)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
+    asynStatus status;
 
-    this->getAddress(pasynUser, &addr);
+    lock();
 
-    static const char *functionName = "writeFloat64";
+    if ( ( req->type == JOB_READ_INT32 ) || ( req->type == JOB_WRITE_INT32 ) )
+        status = getIntegerParam(req->addr, req->function, (int*)&req->u32);
+    else if ( ( req->type == JOB_READ_DIGITAL ) || ( req->type == JOB_WRITE_DIGITAL ) )
+        status = getUIntDigitalParam(req->addr, req->function, &req->u32, req->mask);
+    else
+        status = getDoubleParam(req->addr, req->function, &req->f64);
 
-    this->getAddress(pasynUser, &addr);
+    unlock();
+
+    return ( status == asynSuccess );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::queueRecordRequest(YCPSWASYNRecordRequest *req);               //
+//                                                                                //
+// - Hand the register access of a record to the worker pool. The worker          //
+//   completes it by processing the record again. The first read of a register    //
+//   after the startup prefetch is completed right away, with the prefetched      //
+//   value, and false is returned.                                                //
+////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::queueRecordRequest(YCPSWASYNRecordRequest *req)
+{
+    YCPSWASYNRegisterJob *job;
+    YCPSWASYNDevice      *dev        = NULL;
+    bool                 *prefetched = NULL;
 
     lock();
-    if (!getParamName(addr, function, &name))
+
+    if (req->addr == DEV_REG_RO)
     {
-        try
-        {
-            if (addr == DEV_FLOAT_RW)
-                fw[function]->setVal((double*)&value, 1);
-            else
-                status = asynPortDriver::writeFloat64(pasynUser, value);
-        }
-        catch (CPSWError &e)
-        {
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
-        }
+        dev        = ro.at(req->function).dev;
+        prefetched = &ro.at(req->function).prefetched;
+    }
+    else if (req->addr == DEV_REG_RW)
+    {
+        dev        = rw.at(req->function).dev;
+        prefetched = &rw.at(req->function).prefetched;
+    }
+    else if (req->addr == DEV_FLOAT_RO)
+    {
+        dev        = fo.at(req->function).dev;
+        prefetched = &fo.at(req->function).prefetched;
+    }
+    else
+    {
+        dev        = fw.at(req->function).dev;
+        prefetched = &fw.at(req->function).prefetched;
+    }
 
-        if (status == 0)
-        {
-            asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                        "%s:%s(%d), port %s parameter %s set to %f\n", \
-                        driverName_, functionName, function, this->portName, name, value);
-        }
-        else
+    if ( ( req->type < JOB_WRITE_INT32 ) && *prefetched )
+    {
+        // First read after the startup prefetch (e.g. PINI): return the prefetched value
+        *prefetched = false;
+        unlock();
+
+        getRecordValue(req);
+        return false;
+    }
+
+    // A later read must not return the prefetched value
+    *prefetched = false;
+
+    job          = new YCPSWASYNRegisterJob(this, req->type, req->addr, req->function);
+    job->u32     = req->u32;
+    job->mask    = req->mask;
+    job->f64     = req->f64;
+    job->request = req;
+
+    if (req->type == JOB_WRITE_DIGITAL)
+    {
+        YCPSWASYNRegisterWord *w = registerWord(rw.at(req->function));
+
+        // Merge the bits with the others waiting to be written to the same word. One job
+        // commits them all, and completes all their records.
+        w->pendingValue = ( w->pendingValue & ~req->mask ) | ( req->u32 & req->mask );
+        w->pendingMask |= req->mask;
+        w->waiting.push_back(req);
+
+        if (w->committing)
         {
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                        "%s:%s(%d), port %s ERROR setting parameter %s to %f (status = %d)\n", \
-                        driverName_, functionName, function, this->portName, name, value, status);
+            unlock();
+            return true;
         }
 
+        w->committing = true;
+        job->request  = NULL;
+    }
+    else if (req->addr == DEV_REG_RW)
+    {
+        // Reads of the word keep its value
+        registerWord(rw.at(req->function));
     }
-    else
-        status = asynPortDriver::writeFloat64(pasynUser, value);
 
-    callParamCallbacks(addr);
+    queueRegisterJob(job, dev);
+
     unlock();
 
-    return (status==0) ? asynSuccess : asynError;
+    return true;
 }
 
-asynStatus YCPSWASYN::readFloat64(asynUser *pasynUser, epicsFloat64 *value)
+////////////////////////////////////////////////////////////////////////////////////
+// YCPSWASYNRegisterWord *YCPSWASYN::registerWord(YCPSWASYNRegister<ScalVal>& r); //
+//                                                                                //
+// - Word of an RW register accessed through the digital interface. It is        //
+//   created on the first access, with the port lock taken, before the access     //
+//   is handed to a transaction or a worker.                                      //
+////////////////////////////////////////////////////////////////////////////////////
+YCPSWASYNRegisterWord *YCPSWASYN::registerWord(YCPSWASYNRegister<ScalVal>& r)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    double val;
-    const char *name;
+    if (!r.word)
+        r.word = new YCPSWASYNRegisterWord;
 
-    this->getAddress(pasynUser, &addr);
+    return r.word;
+}
 
-    static const char *functionName = "readFloat64";
+////////////////////////////////////////////////////////////////////////////////////
+// uint32_t YCPSWASYN::commitRegisterWord(YCPSWASYNRegister<ScalVal>& r,          //
+//                                        epicsUInt32 value, epicsUInt32 mask);   //
+//                                                                                //
+// - Write the bits of mask of the word of an RW register, keeping the others,    //
+//   with one masked read-modify-write transaction. The word is only read when    //
+//   its shadow is not known, or was kept before the generation of the device     //
+//   changed (trip, recovery or configuration load), and the mask does not cover  //
+//   the whole register. Called with the device lock taken. Returns the value     //
+//   written; throws CPSWError, leaving the shadow unknown.                       //
+////////////////////////////////////////////////////////////////////////////////////
+uint32_t YCPSWASYN::commitRegisterWord(YCPSWASYNRegister<ScalVal>& r, epicsUInt32 value, epicsUInt32 mask)
+{
+    YCPSWASYNRegisterWord *w          = r.word;
+    int                    generation = epicsAtomicGetIntT(&r.dev->generation);
+    uint64_t               nBits      = r.reg->getSizeBits();
+    epicsUInt32            all        = ( nBits >= 32 ) ? 0xFFFFFFFF : (epicsUInt32)( ( 1ULL << nBits ) - 1 );
+    uint32_t               u32;
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    try
     {
-        try
-        {
-            if (addr == DEV_FLOAT_RO)
-            {
-                fo[function]->getVal(&val, 1);
-                *value = (epicsFloat64)val;
-                setDoubleParam(addr, function, val);
-            }
-            else if (addr == DEV_FLOAT_RW)
-            {
-                fw[function]->getVal(&val, 1);
-                *value = (epicsFloat64)val;
-                setDoubleParam(addr, function, val);;
-            }
-            else
-                status = asynPortDriver::readFloat64(pasynUser, value);
-        }
-        catch (CPSWError &e)
+        if ( ( ( mask & all ) != all ) && ( ( !w->shadowValid ) || ( w->shadowGeneration != generation ) ) )
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            w->shadowValid = false;
+            r.reg->getVal(&u32, 1);
+            w->keep(u32, generation);
         }
-    }
-    else
-        status = asynPortDriver::readFloat64(pasynUser, value);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s read %f from parameter %s\n", \
-                    driverName_, functionName, function, this->portName, *value, name);
+        u32 = ( w->shadow & ~mask ) | ( value & mask );
+        r.reg->setVal(&u32, 1);
     }
-    else
+    catch (CPSWError &e)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, status);
+        w->shadowValid = false;
+        throw;
     }
 
-    callParamCallbacks(addr);
-    unlock();
+    w->keep(u32, generation);
 
-    return (status==0) ? asynSuccess : asynError;
+    return u32;
 }
 
-asynStatus YCPSWASYN::writeInt32Array(asynUser *pasynUser, epicsInt32 *value, size_t nElements)
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::readFieldGroup(YCPSWASYNFieldGroup *g);                        //
+//                                                                                //
+// - Read all the fields of a group with one transaction, and publish each one    //
+//   on its parameter. Called with the port lock taken. The port lock is          //
+//   released during the transaction, and the device lock is kept until the      //
+//   fields are published, so reads of the same group publish in order.          //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::readFieldGroup(YCPSWASYNFieldGroup *g)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    size_t n = 0;
-    const char *name;
-    static const char *functionName = "writeInt32Array";
-    IndexRange range(0, nElements-1);
-
-    this->getAddress(pasynUser, &addr);
+    unlock();
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    try
     {
+        YCPSWASYNDeviceGuard guard(g->dev, LANE_LOW);
+
         try
         {
-            // It was observed that for RW array registers, nElements = 0
-            // Reassign by accessing the CPSW interface and re-compute range
-            nElements = rw[function]->getNelms();
-            IndexRange range(0, nElements-1);
-            
-            if (addr == DEV_REG_RW)
-                n = rw[function]->setVal((uint32_t*)value, nElements, &range);
-            else
-                status = asynPortDriver::writeInt32Array(pasynUser, value, nElements);
+            g->reg->getVal(&g->buffer[0], g->buffer.size());
         }
         catch (CPSWError &e)
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            guard.fail(e);
+            throw;
         }
-    }
-    else
-        status = asynPortDriver::writeInt32Array(pasynUser, value, nElements);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, n);
+        lock();
+
+        for (size_t j = 0; j < g->params.size(); ++j)
+        {
+            if (g->params[j] >= 0)
+                updateUIntDigitalParam(DEV_REG_RO, g->params[j], (epicsUInt32)g->buffer[j], 0xFFFFFFFF);
+        }
     }
-    else
+    catch (CPSWError &e)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, status);
+        lock();
+        throw;
     }
+}
 
-    callParamCallbacks(addr);
-    unlock();
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::finishCommand(int function, int status, double duration);      //
+//                                                                                //
+// - Report the end of a command execution on its parameters. The command         //
+//   parameter goes back to 0, which completes the bo records with an            //
+//   asyn:READBACK info tag. Called with the port lock taken.                     //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::finishCommand(int function, int status, double duration)
+{
+    std::map<int, YCPSWASYNCommandStatus>::iterator it = commandStatus_.find(function);
 
-    return (status==0) ? asynSuccess : asynError;
+    if (it == commandStatus_.end())
+        return;
 
+    it->second.busy = false;
+    setIntegerParam(DEV_CMD, it->second.busyParam, 0);
+    setIntegerParam(DEV_CMD, it->second.statusParam, (status == 0) ? CMD_STAT_SUCCESS : CMD_STAT_ERROR);
+    setDoubleParam(DEV_CMD, it->second.durationParam, duration);
+    setUIntDigitalParam(DEV_CMD, function, 0, 0xFFFFFFFF);
+    callParamCallbacks(DEV_CMD, DEV_CMD);
 }
 
-asynStatus YCPSWASYN::readInt32Array(asynUser *pasynUser, epicsInt32 *value, size_t nElements, size_t *nIn)
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::prefetchRegisters(void);                                       //
+//                                                                                //
+// - Read all scalar registers of this port and its shards into the parameter     //
+//   library before iocInit. The registers are grouped in one batch per device,   //
+//   read with one device lock, and the batches are read in parallel by           //
+//   prefetchThreads threads. The first read of each register (e.g. PINI) then    //
+//   returns the prefetched value, instead of doing its own transaction.          //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::prefetchRegisters(void)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
-    static const char *functionName = "readInt32Array";
-    this->getAddress(pasynUser, &addr);
-    uint64_t buffer[nElements];
+    std::map<YCPSWASYNDevice*, YCPSWASYNPrefetchBatch> batches;
+    YCPSWASYNPrefetch                                   prefetch;
+    epicsTimeStamp                                      start, end;
+    size_t                                              nRegs = 0, nValid = 0;
+    int                                                 nThreads;
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    epicsTimeGetCurrent(&start);
+
+    for (std::size_t i = 0; i < shards_.size(); ++i)
     {
-        try
-        {
-            if (addr == DEV_REG_RO)
-            {
-                ro[function]->getVal(buffer, nElements);
-                std::copy(buffer, buffer+nElements, value);
-                *nIn = nElements;
-            }
-            else if (addr == DEV_REG_RW)
-            {
-                rw[function]->getVal(buffer, nElements);
-                std::copy(buffer, buffer+nElements, value);
-                *nIn = nElements;
-            }
-            else
-                status = asynPortDriver::readInt32Array(pasynUser, value, nElements, nIn);
-        }
-        catch (CPSWError &e)
+        shards_[i]->addPrefetchEntries(shards_[i]->ro, DEV_REG_RO,   batches);
+        shards_[i]->addPrefetchEntries(shards_[i]->rw, DEV_REG_RW,   batches);
+        shards_[i]->addPrefetchEntries(shards_[i]->fo, DEV_FLOAT_RO, batches);
+        shards_[i]->addPrefetchEntries(shards_[i]->fw, DEV_FLOAT_RW, batches);
+    }
+
+    if (batches.empty())
+        return;
+
+    for (std::map<YCPSWASYNDevice*, YCPSWASYNPrefetchBatch>::iterator it = batches.begin(); it != batches.end(); ++it)
+        prefetch.batches.push_back(it->second);
+
+    nThreads         = std::min(prefetchThreads, static_cast<int>(prefetch.batches.size()));
+    prefetch.running = nThreads;
+
+    for (int i = 0; i < nThreads; ++i)
+    {
+        std::stringstream threadName;
+        threadName << portName_ << "_P" << i;
+
+        if ( ! epicsThreadCreate(threadName.str().c_str(), epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)YCPSWASYN::prefetchTask, &prefetch) )
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            printf("ERROR: Unable to create prefetch thread %s\n", threadName.str().c_str());
+
+            if (epicsAtomicDecrIntT(&prefetch.running) == 0)
+                prefetch.done.signal();
         }
     }
-    else
-        status = asynPortDriver::readInt32Array(pasynUser, value, nElements, nIn);
 
-    if (status == 0)
+    // Called from the constructor, so the port locks are free for the prefetch threads
+    if (nThreads > 0)
+        prefetch.done.wait();
+
+    epicsTimeGetCurrent(&end);
+
+    for (std::size_t i = 0; i < prefetch.batches.size(); ++i)
     {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s got parameter %s, requested = %zu, got = %zu\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+        nRegs += prefetch.batches[i].entries.size();
+        for (std::size_t j = 0; j < prefetch.batches[i].entries.size(); ++j)
+            if (prefetch.batches[i].entries[j].valid)
+                ++nValid;
     }
-    else
+
+    printf("Port %s: prefetched %zu of %zu registers from %zu devices in %f seconds\n",
+        portName_, nValid, nRegs, prefetch.batches.size(), epicsTimeDiffInSeconds(&end, &start));
+}
+
+template <typename T>
+void YCPSWASYN::addPrefetchEntries(YCPSWASYNRegisterTable<T>& table, int list, std::map<YCPSWASYNDevice*, YCPSWASYNPrefetchBatch>& batches)
+{
+    for (std::size_t i = 0; i < table.slots(); ++i)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR getting  parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, status);
+        YCPSWASYNPrefetchEntry e;
+
+        if ( !table.contains(i) || ( getParamType(list, i, &e.type) != asynSuccess ) )
+            continue;
+
+        // Only scalar registers; arrays and strings are left to their records
+        if ( ( e.type != asynParamInt32 ) && ( e.type != asynParamUInt32Digital ) && ( e.type != asynParamFloat64 ) )
+            continue;
+
+        YCPSWASYNRegister<T>&   r = table.at(i);
+        YCPSWASYNPrefetchBatch& b = batches[r.dev];
+
+        b.drv        = this;
+        b.dev        = r.dev;
+        e.list       = list;
+        e.index      = i;
+        e.prefetched = &r.prefetched;
+        e.u32        = 0;
+        e.f64        = 0;
+        e.valid      = false;
+        b.entries.push_back(e);
     }
+}
 
-    callParamCallbacks(addr);
-    unlock();
+void YCPSWASYN::prefetchTask(void *arg)
+{
+    YCPSWASYNPrefetch *prefetch = static_cast<YCPSWASYNPrefetch*>(arg);
+    size_t            i;
 
-    return (status==0) ? asynSuccess : asynError;
+    while ( ( i = epicsAtomicIncrIntT(&prefetch->next) - 1 ) < prefetch->batches.size() )
+    {
+        YCPSWASYNPrefetchBatch& b = prefetch->batches[i];
+        b.drv->prefetchBatch(b);
+    }
+
+    if (epicsAtomicDecrIntT(&prefetch->running) == 0)
+        prefetch->done.signal();
 }
 
-asynStatus YCPSWASYN::readOctet(asynUser *pasynUser, char *value, size_t maxChars, size_t *nActual, int *eomReason)
+void YCPSWASYN::prefetchBatch(YCPSWASYNPrefetchBatch& b)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
-    static const char *functionName = "readOctet";
-    uint8_t buffer[maxChars];
-    this->getAddress(pasynUser, &addr);
+    size_t nValid       = 0;
+    size_t nRead        = 0;
+    int    nUnreachable = 0;    // Consecutive reads which found the device not reachable
+    int    abortAfter   = ( b.dev->tripThreshold > 0 ) ? b.dev->tripThreshold : 1;
+    bool   aborted      = false;
+    bool   tripped      = false;
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    try
     {
-        try
+        YCPSWASYNDeviceGuard g(b.dev, LANE_LOW);
+
+        for (; nRead < b.entries.size(); ++nRead)
         {
-            if (addr == DEV_REG_RO)
+            YCPSWASYNPrefetchEntry& e = b.entries[nRead];
+
+            try
             {
-                ro[function]->getVal(buffer, maxChars);
-                std::copy(buffer, buffer+maxChars, value);
-                *nActual = maxChars;
+                if (e.list == DEV_REG_RO)
+                    ro.at(e.index).reg->getVal(&e.u32, 1);
+                else if (e.list == DEV_REG_RW)
+                    rw.at(e.index).reg->getVal(&e.u32, 1);
+                else if (e.list == DEV_FLOAT_RO)
+                    fo.at(e.index).reg->getVal(&e.f64, 1);
+                else if (e.list == DEV_FLOAT_RW)
+                    fw.at(e.index).reg->getVal(&e.f64, 1);
+
+                e.valid      = true;
+                nUnreachable = 0;
+                ++nValid;
             }
-            else if (addr == DEV_REG_RW)
+            catch (CPSWError &err)
             {
-                rw[function]->getVal(buffer, maxChars);
-                std::copy(buffer, buffer+maxChars, value);
-                *nActual = maxChars;
+                // The register is read by its record later
+                if (YCPSWASYNDevice::resultOf(err) == RESULT_UNREACHABLE)
+                    ++nUnreachable;
+            }
+
+            // Each of the remaining reads would wait for its timeout too. They are left to the
+            // records, which fail right away while the device is tripped.
+            if (nUnreachable >= abortAfter)
+            {
+                if (b.dev->tripThreshold > 0)
+                    tripped = b.dev->trip();
+
+                aborted = true;
+                ++nRead;
+                break;
             }
-            else
-                status = asynPortDriver::readOctet(pasynUser, value, maxChars, nActual, eomReason);
-        }
-        catch (CPSWError &e)
-        {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
         }
-    }
-    else
-        status = asynPortDriver::readOctet(pasynUser, value, maxChars, nActual, eomReason);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s maxChars = %zu, nActual = %zu, eomReason %d\n", \
-                    driverName_, functionName, function, this->portName, maxChars, *nActual, *eomReason);
+        // The device is counted as not reachable only if none of its registers answered,
+        // or the batch was aborted
+        if ( ( ( nValid == 0 ) && ( nUnreachable > 0 ) ) || aborted )
+            g.fail();
     }
-    else
+    catch (YCPSWASYNDeviceDown &err)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR getting parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, maxChars, status);
+        // The device was tripped by another batch of the same device
     }
 
-    callParamCallbacks(addr);
-    unlock();
+    if ( aborted && ( nRead < b.entries.size() ) )
+        printf("Device %s did not answer the startup prefetch: %zu of its registers were not read%s\n",
+            b.dev->name.c_str(), b.entries.size() - nRead, tripped ? ". Requests to it will fail until it is back." : "");
 
-    return (status==0) ? asynSuccess : asynError;
-}
+    lock();
 
-asynStatus YCPSWASYN::writeOctet (asynUser *pasynUser, const char *value, size_t maxChars, size_t *nActual)
+    for (std::size_t i = 0; i < b.entries.size(); ++i)
+    {
+        YCPSWASYNPrefetchEntry& e = b.entries[i];
+
+        if (!e.valid)
+            continue;
+
+        if (e.type == asynParamInt32)
+            setIntegerParam(e.list, e.index, (int)e.u32);
+        else if (e.type == asynParamUInt32Digital)
+            setUIntDigitalParam(e.list, e.index, (epicsUInt32)e.u32, 0xFFFFFFFF);
+        else
+            setDoubleParam(e.list, e.index, e.f64);
+
+        *e.prefetched = true;
+    }
+
+    unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// int YCPSWASYN::reportError(asynUser *pasynUser, const char *functionName,      //
+//                            const char *name, CPSWError& e);                    //
+//                                                                                //
+// - Report a CPSW error on a request. Requests to a tripped device fail without  //
+//   a transaction; they are not printed, but counted on DEVICE_ERRORS, and set   //
+//   a COMM alarm on the record. Returns asynDisconnected for them, so the        //
+//   callers skip their own error message, and -1 for any other error.           //
+////////////////////////////////////////////////////////////////////////////////////
+int YCPSWASYN::reportError(asynUser *pasynUser, const char *functionName, const char *name, CPSWError& e)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
-    static const char *functionName = "writeOctet";
-    this->getAddress(pasynUser, &addr);
-    IndexRange range(0, maxChars-1);
+    if (dynamic_cast<YCPSWASYNDeviceDown*>(&e))
+    {
+        pasynUser->alarmStatus   = COMM_ALARM;
+        pasynUser->alarmSeverity = INVALID_ALARM;
+        return asynDisconnected;
+    }
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name ? name : "", e.getInfo().c_str());
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::probeDevices(void);                                            //
+//                                                                                //
+// - Body of the device health thread, started when deviceTripCount is set.       //
+//   Every deviceProbePeriod seconds, read the probe register of each tripped     //
+//   device of this port and its shards, and put the device back in service if   //
+//   it succeeds. Then update DEVICES_DOWN and DEVICE_ERRORS.                     //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::healthTask(void *arg)
+{
+    static_cast<YCPSWASYN*>(arg)->probeDevices();
+}
+
+void YCPSWASYN::probeDevices(void)
+{
+    for(;;)
     {
-        try
+        int nDown   = 0;
+        int nErrors = 0;
+
+        epicsThreadSleep(deviceProbePeriod);
+
+        for (std::size_t i = 0; i < shards_.size(); ++i)
         {
-            if (addr == DEV_REG_RW)
-            {
-                *nActual = (size_t)rw[function]->setVal((uint8_t*)value, maxChars, &range);
-                if (*nActual <= 0)
-                        status = -1;
-            }
-            else if (addr == DEV_CONFIG)
+            std::map<std::string, YCPSWASYNDevice*>& devices = shards_[i]->devices_;
+
+            for (std::map<std::string, YCPSWASYNDevice*>::iterator it = devices.begin(); it != devices.end(); ++it)
             {
-                if (function == saveConfigFileValue_)
-                {
-                    saveConfigFileName = std::string(value);
-                    *nActual = maxChars;
-                    status = setStringParam(DEV_CONFIG, saveConfigFileValue_, value);
-                }
-                else if (function == loadConfigFileValue_)
+                YCPSWASYNDevice *dev = it->second;
+
+                nErrors += epicsAtomicGetIntT(&dev->failedRequests);
+
+                if (!epicsAtomicGetIntT(&dev->tripped))
+                    continue;
+
+                // Devices without a scalar register to probe let their next request through.
+                // They stay tripped until that request succeeds.
+                if ( !dev->probe && !dev->probeDouble )
                 {
-                    loadConfigFileName = std::string(value);
-                    *nActual = maxChars;
-                    status = setStringParam(DEV_CONFIG, loadConfigFileValue_, value);
+                    epicsAtomicSetIntT(&dev->trial, 1);
+                    ++nDown;
+                    continue;
                 }
-                else if (function == loadConfigRootValue_)
+
+                try
                 {
-                    loadConfigRootPath = std::string(value);
-                    *nActual = maxChars;
-                    status = setStringParam(DEV_CONFIG, loadConfigRootValue_, value);
+                    epicsGuard<epicsMutex> g(dev->lock);
+                    uint32_t               u32;
+                    double                 f64;
+
+                    if (dev->probe)
+                        dev->probe->getVal(&u32, 1);
+                    else
+                        dev->probeDouble->getVal(&f64, 1);
+
+                    dev->failures = 0;
+                    epicsAtomicSetIntT(&dev->tripped, 0);
+                    epicsAtomicIncrIntT(&dev->generation);
                 }
-                else if (function == saveConfigRootValue_)
+                catch (CPSWError &e)
                 {
-                    saveConfigRootPath = std::string(value);
-                    *nActual = maxChars;
-                    status = setStringParam(DEV_CONFIG, saveConfigRootValue_, value);
+                    ++nDown;
+                    continue;
                 }
-                else
-                    status = writeOctet (pasynUser, value, maxChars, nActual);
+
+                printf("Device %s is reachable again\n", dev->name.c_str());
             }
-            else
-                status = writeOctet (pasynUser, value, maxChars, nActual);
-        }
-        catch (CPSWError &e)
-        {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
         }
-    }
-    else
-        status = writeOctet (pasynUser, value, maxChars, nActual);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
-                    driverName_, functionName, function, this->portName, name, maxChars, *nActual);
+        lock();
+        setIntegerParam(DEV_CONFIG, devicesDownValue_,  nDown);
+        setIntegerParam(DEV_CONFIG, deviceErrorsValue_, nErrors);
+        callParamCallbacks(DEV_CONFIG);
+        unlock();
     }
-    else
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::createLatencyParams(void);                                     //
+//                                                                                //
+// - Create the latency statistics parameters of each lane, on the DEV_CONFIG     //
+//   list: LATENCY_<lane>_COUNT (number of requests), LATENCY_<lane>_MEAN and     //
+//   LATENCY_<lane>_MAX (mean and max latency in seconds), and LATENCY_RESET      //
+//   to clear them.                                                               //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::createLatencyParams(void)
+{
+    for (int i = 0; i < LANE_SIZE; ++i)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, maxChars, status);
+        std::string prefix = std::string(LATENCY_PREFIX) + laneNames[i];
+
+        createParam(DEV_CONFIG, (prefix + LATENCY_COUNT_SUFFIX).c_str(), asynParamInt32,   &latency_[i].countParam);
+        createParam(DEV_CONFIG, (prefix + LATENCY_MEAN_SUFFIX).c_str(),  asynParamFloat64, &latency_[i].meanParam);
+        createParam(DEV_CONFIG, (prefix + LATENCY_MAX_SUFFIX).c_str(),   asynParamFloat64, &latency_[i].maxParam);
     }
 
-    callParamCallbacks(addr);
-    unlock();
+    createParam(DEV_CONFIG, latencyResetString, asynParamInt32, &latencyResetValue_);
+    setIntegerParam(DEV_CONFIG, latencyResetValue_, 0);
 
-    return (status==0) ? asynSuccess : asynError;
+    resetLatency();
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::addLatency(int lane, double latency);                          //
+// void YCPSWASYN::addLatency(int lane, const epicsTimeStamp& since);             //
+//                                                                                //
+// - Add a request served on a lane to its latency statistics. The parameters     //
+//   are updated without callbacks; they are meant to be read periodically.       //
+//   Called with the port lock taken.                                             //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::addLatency(int lane, double latency)
+{
+    YCPSWASYNLatencyStats& l = latency_[lane];
 
-asynStatus YCPSWASYN::readFloat64Array(asynUser *pasynUser, epicsFloat64 *value, size_t nElements, size_t *nIn)
+    ++l.count;
+    l.sum += latency;
+    if (latency > l.max)
+        l.max = latency;
+
+    setIntegerParam(DEV_CONFIG, l.countParam, (int)l.count);
+    setDoubleParam(DEV_CONFIG,  l.meanParam,  l.sum / l.count);
+    setDoubleParam(DEV_CONFIG,  l.maxParam,   l.max);
+}
+
+void YCPSWASYN::addLatency(int lane, const epicsTimeStamp& since)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    uint64_t buffer[nElements];
-    this->getAddress(pasynUser, &addr);
-    const char *name;
+    epicsTimeStamp now;
 
-    static const char *functionName = "readFloat64Array";
+    epicsTimeGetCurrent(&now);
+    addLatency(lane, epicsTimeDiffInSeconds(&now, &since));
+}
 
-    lock();
-    if (!getParamName(addr, function, &name))
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::resetLatency(void);                                            //
+//                                                                                //
+// - Clear the latency statistics of all lanes. Called with the port lock taken.  //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::resetLatency(void)
+{
+    for (int i = 0; i < LANE_SIZE; ++i)
+    {
+        latency_[i].count = 0;
+        latency_[i].sum   = 0;
+        latency_[i].max   = 0;
+
+        setIntegerParam(DEV_CONFIG, latency_[i].countParam, 0);
+        setDoubleParam(DEV_CONFIG,  latency_[i].meanParam,  0);
+        setDoubleParam(DEV_CONFIG,  latency_[i].maxParam,   0);
+    }
+}
+
+void YCPSWASYNRegisterJob::run()
+{
+    drv->processRegisterJob(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::processRegisterJob(YCPSWASYNRegisterJob *job);                 //
+//                                                                                //
+// - Do a register access from a worker thread. The transaction is done holding   //
+//   the device lock only; the port lock is taken afterwards to update the        //
+//   parameter and its status, whose callbacks update the I/O Intr and read-back  //
+//   records. The parameter of a write only takes the value once it is written.   //
+//   A digital write commits the bits of all the writes merged on its word since  //
+//   it was queued. The records waiting for the access are processed again to     //
+//   complete them.                                                               //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::processRegisterJob(YCPSWASYNRegisterJob *job)
+{
+    uint32_t    u32 = 0;
+    double      f64 = 0;
+    int         status = 0;
+    std::string error;
+    bool        down = false;   // The device is not reachable; the error is not printed
+    const char  *name = NULL;
+
+    static const char *functionName = "processRegisterJob";
+
+    // Commands run on the command executor, without the port lock
+    if (job->type == JOB_EXECUTE_COMMAND)
     {
+        epicsTimeStamp start = job->queued, end;
+
         try
         {
-            if (addr == DEV_REG_RO)
+            YCPSWASYNRegister<Command>& r = cmd.at(job->function);
+            YCPSWASYNDeviceGuard        g(r.dev, job->lane);
+
+            // The latency of a command is the time until it starts
+            epicsTimeGetCurrent(&start);
+
+            try
             {
-                ro[function]->getVal(buffer, nElements);
-                std::copy(buffer, buffer+nElements, value);
-                *nIn = nElements;
+                r.reg->execute();
             }
-            else if (addr == DEV_REG_RW)
+            catch (CPSWError &e)
             {
-                rw[function]->getVal(buffer, nElements);
-                std::copy(buffer, buffer+nElements, value);
-                *nIn = nElements;
+                g.fail(e);
+                throw;
             }
-            else
-                status = asynPortDriver::readFloat64Array(pasynUser, value, nElements, nIn);
         }
         catch (CPSWError &e)
         {
             status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            error  = e.getInfo();
+            down   = ( dynamic_cast<YCPSWASYNDeviceDown*>(&e) != NULL );
+        }
+
+        epicsTimeGetCurrent(&end);
+
+        lock();
+
+        addLatency(job->lane, epicsTimeDiffInSeconds(&start, &job->queued));
+        finishCommand(job->function, status, epicsTimeDiffInSeconds(&end, &start));
+
+        if ( ( status != 0 ) && !down )
+        {
+            getParamName(job->addr, job->function, &name);
+            asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name ? name : "", error.c_str());
         }
+
+        unlock();
+        return;
     }
-    else
-        status = asynPortDriver::readFloat64Array(pasynUser, value, nElements, nIn);
 
-    if (status == 0)
+    // Fields of a group are read all together, and published with the port lock taken
+    if ( ( job->addr == DEV_REG_RO ) && ro.at(job->function).group )
     {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s get parameter %s. Requested = %zu, got = %zu\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+        lock();
+
+        try
+        {
+            readFieldGroup(ro.at(job->function).group);
+            addLatency(job->lane, job->queued);
+
+            if (job->request)
+                getUIntDigitalParam(job->addr, job->function, &job->request->u32, job->request->mask);
+        }
+        catch (CPSWError &e)
+        {
+            YCPSWASYNFieldGroup *g = ro.at(job->function).group;
+            asynStatus          failed;
+
+            getParamName(job->addr, job->function, &name);
+            failed = ( reportError(pasynUserSelf, functionName, name, e) == asynDisconnected ) ? asynDisconnected : asynError;
+
+            for (size_t j = 0; j < g->params.size(); ++j)
+            {
+                if (g->params[j] >= 0)
+                    setParamStatus(DEV_REG_RO, g->params[j], failed);
+            }
+
+            callParamCallbacks(DEV_REG_RO, DEV_REG_RO);
+
+            if (job->request)
+            {
+                job->request->status = -1;
+                job->request->down   = ( failed == asynDisconnected );
+            }
+        }
+
+        if (job->readPending)
+            *job->readPending = false;
+
+        unlock();
+
+        if (job->request)
+            callbackRequestProcessCallback(&job->request->callback, job->request->rec->prio, job->request->rec);
+
+        return;
     }
-    else
+
+    std::vector<YCPSWASYNRecordRequest*> requests;     // Records waiting for the access
+    epicsUInt32                          value = job->u32, mask = job->mask;
+
+    if (job->request)
+        requests.push_back(job->request);
+
+    // A write of a word commits all the bits merged since the job was queued
+    if (job->type == JOB_WRITE_DIGITAL)
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR getting parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, status);
+        YCPSWASYNRegisterWord *w = rw.at(job->function).word;
+
+        lock();
+
+        value           = w->pendingValue;
+        mask            = w->pendingMask;
+        w->pendingValue = 0;
+        w->pendingMask  = 0;
+        w->committing   = false;
+        requests.insert(requests.end(), w->waiting.begin(), w->waiting.end());
+        w->waiting.clear();
+
+        unlock();
     }
 
-    callParamCallbacks();
-    unlock();
+    // The register tables don't change after initialization, so they can be read without the port lock
+    try
+    {
+        if (job->addr == DEV_REG_RO)
+        {
+            YCPSWASYNRegister<ScalVal_RO>& r = ro.at(job->function);
+            YCPSWASYNDeviceGuard           g(r.dev, job->lane);
 
-    return (status==0) ? asynSuccess : asynError;
+            try
+            {
+                r.reg->getVal(&u32, 1);
+            }
+            catch (CPSWError &e)
+            {
+                g.fail(e);
+                throw;
+            }
+        }
+        else if (job->addr == DEV_REG_RW)
+        {
+            YCPSWASYNRegister<ScalVal>& r = rw.at(job->function);
+            YCPSWASYNDeviceGuard        g(r.dev, job->lane);
 
-}
+            try
+            {
+                if (job->type == JOB_WRITE_DIGITAL)
+                    u32 = commitRegisterWord(r, value, mask);
+                else if (job->type == JOB_WRITE_INT32)
+                {
+                    u32 = job->u32;
+                    r.reg->setVal(&u32, 1);
+                }
+                else
+                {
+                    r.reg->getVal(&u32, 1);
 
-asynStatus YCPSWASYN::writeFloat64Array(asynUser *pasynUser, epicsFloat64 *value, size_t nElements)
-{
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    size_t n = 0;
-    this->getAddress(pasynUser, &addr);
-    const char *name;
-    IndexRange range(0, nElements-1);
+                    // The word was created before the job was queued
+                    if (job->type == JOB_READ_DIGITAL)
+                        r.word->keep(u32, epicsAtomicGetIntT(&r.dev->generation));
+                }
+            }
+            catch (CPSWError &e)
+            {
+                g.fail(e);
+                throw;
+            }
+        }
+        else if (job->addr == DEV_FLOAT_RO)
+        {
+            YCPSWASYNRegister<DoubleVal_RO>& r = fo.at(job->function);
+            YCPSWASYNDeviceGuard             g(r.dev, job->lane);
 
-    static const char *functionName = "writeFloat64Array";
+            try
+            {
+                r.reg->getVal(&f64, 1);
+            }
+            catch (CPSWError &e)
+            {
+                g.fail(e);
+                throw;
+            }
+        }
+        else if (job->addr == DEV_FLOAT_RW)
+        {
+            YCPSWASYNRegister<DoubleVal>& r = fw.at(job->function);
+            YCPSWASYNDeviceGuard          g(r.dev, job->lane);
+
+            try
+            {
+                if (job->type == JOB_WRITE_FLOAT64)
+                {
+                    f64 = job->f64;
+                    r.reg->setVal(&f64, 1);
+                }
+                else
+                    r.reg->getVal(&f64, 1);
+            }
+            catch (CPSWError &e)
+            {
+                g.fail(e);
+                throw;
+            }
+        }
+    }
+    catch (CPSWError &e)
+    {
+        status = -1;
+        error  = e.getInfo();
+        down   = ( dynamic_cast<YCPSWASYNDeviceDown*>(&e) != NULL );
+    }
 
     lock();
-    if (!getParamName(addr, function, &name))
+
+    if (job->readPending)
+        *job->readPending = false;
+
+    addLatency(job->lane, job->queued);
+
+    if (status == 0)
     {
-        try
+        if (job->type == JOB_READ_INT32)
+            updateIntegerParam(job->addr, job->function, (int)u32);
+        else if (job->type == JOB_READ_DIGITAL)
+            updateUIntDigitalParam(job->addr, job->function, (epicsUInt32)u32 & job->mask, job->mask);
+        else if (job->type == JOB_READ_FLOAT64)
+            updateDoubleParam(job->addr, job->function, f64);
+        else
         {
-            if (addr == DEV_REG_RW)
-                n = rw[function]->setVal((uint32_t*)value, nElements, &range);
-            else
-                status = asynPortDriver::writeFloat64Array(pasynUser, value, nElements);
+            if (job->type == JOB_WRITE_INT32)
+                setIntegerParam(job->addr, job->function, (int)job->u32);
+            else if (job->type == JOB_WRITE_DIGITAL)
+                setUIntDigitalParam(job->addr, job->function, u32, 0xFFFFFFFF);
+            else if (job->type == JOB_WRITE_FLOAT64)
+                setDoubleParam(job->addr, job->function, job->f64);
+
+            setParamStatus(job->addr, job->function, asynSuccess);
+            callParamCallbacks(job->addr, job->addr);
         }
-        catch (CPSWError &e)
+    }
+    else
+    {
+        if (!down)
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            getParamName(job->addr, job->function, &name);
+            asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name ? name : "", error.c_str());
         }
+
+        // Devices which are down set a COMM alarm, other failures a READ or WRITE alarm
+        setParamStatus(job->addr, job->function, down ? asynDisconnected : asynError);
+        callParamCallbacks(job->addr, job->addr);
     }
-    else
-        status = asynPortDriver::writeFloat64Array(pasynUser, value, nElements);
 
-    if (status == 0)
+    unlock();
+
+    // The records waiting for the access are completed by their own processing
+    for (size_t i = 0; i < requests.size(); ++i)
     {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, n);
+        YCPSWASYNRecordRequest *req = requests[i];
+
+        req->status = status;
+        req->down   = down;
+
+        if (job->type == JOB_READ_DIGITAL)
+            req->u32 = (epicsUInt32)u32 & mask;
+        else if (job->type == JOB_READ_INT32)
+            req->u32 = (epicsUInt32)u32;
+        else if (job->type == JOB_READ_FLOAT64)
+            req->f64 = f64;
+
+        callbackRequestProcessCallback(&req->callback, req->rec->prio, req->rec);
+    }
+}
+
+// Add the parameters (list and index) of the clients registered on an interrupt
+// interface of the port. I is the interrupt type of the interface.
+template <typename I>
+static void findInterruptClients(void *interruptPvt, std::set< std::pair<int, int> >& clients)
+{
+    ELLLIST       *pclientList;
+    interruptNode *pnode;
+
+    if ( ( ! interruptPvt ) || ( pasynManager->interruptStart(interruptPvt, &pclientList) != asynSuccess ) )
+        return;
+
+    for (pnode = (interruptNode *)ellFirst(pclientList); pnode; pnode = (interruptNode *)ellNext(&pnode->node))
+    {
+        I *pInterrupt = (I *)pnode->drvPvt;
+        clients.insert(std::make_pair(pInterrupt->addr, pInterrupt->pasynUser->reason));
+    }
+
+    pasynManager->interruptEnd(interruptPvt);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::pollRegisters(void);                                           //
+//                                                                                //
+// - Body of the poll thread, started in asynchronous mode when a poll period is  //
+//   set. Every asyncPollPeriod seconds, queue a read of each scalar register of  //
+//   this port and its shards which has I/O Intr records. The workers keep these  //
+//   reads in flight together, and the records are updated by the parameter      //
+//   callbacks.                                                                   //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::pollTask(void *arg)
+{
+    static_cast<YCPSWASYN*>(arg)->pollRegisters();
+}
+
+void YCPSWASYN::pollRegisters(void)
+{
+    for(;;)
+    {
+        epicsThreadSleep(asyncPollPeriod);
+
+        for (std::size_t i = 0; i < shards_.size(); ++i)
+            shards_[i]->queueInterruptReads();
+    }
+}
+
+void YCPSWASYN::queueInterruptReads(void)
+{
+    std::set< std::pair<int, int> > clients;
+    asynParamType                   type;
+
+    lock();
+
+    findInterruptClients<asynInt32Interrupt>(asynStdInterfaces.int32InterruptPvt, clients);
+    findInterruptClients<asynUInt32DigitalInterrupt>(asynStdInterfaces.uInt32DigitalInterruptPvt, clients);
+    findInterruptClients<asynFloat64Interrupt>(asynStdInterfaces.float64InterruptPvt, clients);
+
+    for (std::set< std::pair<int, int> >::iterator it = clients.begin(); it != clients.end(); ++it)
+    {
+        int addr     = it->first;
+        int function = it->second;
+
+        if ( ( addr < 0 ) || ( addr >= MAX_SIGNALS ) || windowParams_[addr].count(function) ||
+             ( getParamType(addr, function, &type) != asynSuccess ) )
+            continue;
+
+        if ( ( addr == DEV_REG_RO ) && ro.contains(function) )
+        {
+            YCPSWASYNRegister<ScalVal_RO>& r = ro.at(function);
+
+            if (type == asynParamInt32)
+                queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_INT32, addr, function), r.dev, &r.readPending);
+            else if (type == asynParamUInt32Digital)
+                queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_DIGITAL, addr, function), r.dev, &r.readPending);
+        }
+        else if ( ( addr == DEV_REG_RW ) && rw.contains(function) )
+        {
+            YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+
+            if (type == asynParamInt32)
+                queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_INT32, addr, function), r.dev, &r.readPending);
+            else if (type == asynParamUInt32Digital)
+            {
+                // Reads of the word keep its value
+                registerWord(r);
+                queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_DIGITAL, addr, function), r.dev, &r.readPending);
+            }
+        }
+        else if ( ( addr == DEV_FLOAT_RO ) && fo.contains(function) && ( type == asynParamFloat64 ) )
+        {
+            YCPSWASYNRegister<DoubleVal_RO>& r = fo.at(function);
+            queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_FLOAT64, addr, function), r.dev, &r.readPending);
+        }
+        else if ( ( addr == DEV_FLOAT_RW ) && fw.contains(function) && ( type == asynParamFloat64 ) )
+        {
+            YCPSWASYNRegister<DoubleVal>& r = fw.at(function);
+            queueRegisterJob(new YCPSWASYNRegisterJob(this, JOB_READ_FLOAT64, addr, function), r.dev, &r.readPending);
+        }
+    }
+
+    unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::createArrayWindow(YCPSWASYNRegister<T>& r, int list,           //
+//                                   int paramIndex, unsigned nelms);             //
+//                                                                                //
+// - Create the window parameters of an array register: <param>:OFS is the first  //
+//   element transferred and <param>:LEN the maximum number of elements           //
+//   transferred (0 = up to the end of the array).                                //
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void YCPSWASYN::createArrayWindow(YCPSWASYNRegister<T>& r, int list, int paramIndex, unsigned nelms)
+{
+    const char *name;
+
+    if ( ( nelms <= 1 ) || ( getParamName(list, paramIndex, &name) != asynSuccess ) )
+        return;
+
+    std::string paramName(name);
+
+    createParam(list, (paramName + ARRAY_OFFSET_SUFFIX).c_str(), asynParamInt32, &r.ofsParam);
+    createParam(list, (paramName + ARRAY_LENGTH_SUFFIX).c_str(), asynParamInt32, &r.lenParam);
+    setIntegerParam(list, r.ofsParam, 0);
+    setIntegerParam(list, r.lenParam, 0);
+
+    windowParams_[list].insert(r.ofsParam);
+    windowParams_[list].insert(r.lenParam);
+}
+
+template <typename T>
+void YCPSWASYN::getArrayWindow(YCPSWASYNRegister<T>& r, int list, size_t nElements, size_t& first, size_t& n)
+{
+    size_t nelms = r.reg->getNelms();
+    int    ofs   = 0;
+    int    len   = 0;
+
+    if (r.ofsParam >= 0)
+    {
+        getIntegerParam(list, r.ofsParam, &ofs);
+        getIntegerParam(list, r.lenParam, &len);
+    }
+
+    first = ( ofs > 0 ) ? std::min(static_cast<size_t>(ofs), nelms) : 0;
+    n     = nelms - first;
+
+    if ( ( len > 0 ) && ( static_cast<size_t>(len) < n ) )
+        n = len;
+
+    if ( nElements < n )
+        n = nElements;
+}
+
+// Transfer of array elements between a register and an asyn client buffer. Registers
+// as wide as the client type, and DoubleVals, use the client buffer directly. Wider registers,
+// and integer registers accessed as floating point, go through the register's
+// conversion buffer. Called inside the register's transaction.
+template <typename T, typename V>
+static unsigned getArray(YCPSWASYNRegister<T>& r, V *value, size_t n, IndexRange *range)
+{
+    if (r.reg->getSizeBits() <= 8 * sizeof(V))
+        return r.reg->getVal(reinterpret_cast<typename YCPSWASYNNativeType<V>::type*>(value), n, range);
+
+    uint64_t *buffer = r.scratchBuffer(n);
+    unsigned got     = r.reg->getVal(buffer, n, range);
+    std::copy(buffer, buffer + got, value);
+
+    return got;
+}
+
+template <typename T>
+static unsigned getArray(YCPSWASYNRegister<T>& r, epicsFloat64 *value, size_t n, IndexRange *range)
+{
+    uint64_t *buffer = r.scratchBuffer(n);
+    unsigned got     = r.reg->getVal(buffer, n, range);
+    std::copy(buffer, buffer + got, value);
+
+    return got;
+}
+
+static unsigned getArray(YCPSWASYNRegister<DoubleVal_RO>& r, epicsFloat64 *value, size_t n, IndexRange *range)
+{
+    return r.reg->getVal(value, n, range);
+}
+
+static unsigned getArray(YCPSWASYNRegister<DoubleVal>& r, epicsFloat64 *value, size_t n, IndexRange *range)
+{
+    return r.reg->getVal(value, n, range);
+}
+
+template <typename V>
+static unsigned setArray(YCPSWASYNRegister<ScalVal>& r, V *value, size_t n, IndexRange *range)
+{
+    return r.reg->setVal(reinterpret_cast<typename YCPSWASYNNativeType<V>::type*>(value), n, range);
+}
+
+static unsigned setArray(YCPSWASYNRegister<ScalVal>& r, epicsFloat64 *value, size_t n, IndexRange *range)
+{
+    uint64_t *buffer = r.scratchBuffer(n);
+    std::copy(value, value + n, buffer);
+
+    return r.reg->setVal(buffer, n, range);
+}
+
+static unsigned setArray(YCPSWASYNRegister<DoubleVal>& r, epicsFloat64 *value, size_t n, IndexRange *range)
+{
+    return r.reg->setVal(value, n, range);
+}
+
+// Find the span [from, to) of elements which differ between two arrays. The arrays are
+// compared in blocks with memcmp, which the C library vectorizes, from both ends.
+// Returns false if the arrays are equal.
+template <typename V>
+static bool changedSpan(const V *value, const V *committed, size_t n, size_t& from, size_t& to)
+{
+    const size_t block = ARRAY_COMPARE_BLOCK_SIZE / sizeof(V);
+    size_t       len;
+
+    for (from = 0; from < n; from += len)
+    {
+        len = std::min(block, n - from);
+        if (memcmp(value + from, committed + from, len * sizeof(V)))
+            break;
+    }
+
+    if (from == n)
+        return false;
+
+    while (!memcmp(value + from, committed + from, sizeof(V)))
+        ++from;
+
+    for (to = n; to > from; to -= len)
+    {
+        len = std::min(block, to - from);
+        if (memcmp(value + to - len, committed + to - len, len * sizeof(V)))
+            break;
+    }
+
+    while (!memcmp(value + to - 1, committed + to - 1, sizeof(V)))
+        --to;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// size_t YCPSWASYN::readRegisterArray(YCPSWASYNRegister<T>& r, int list,         //
+//                                     V *value, size_t nElements,                //
+//                                     asynUser *pasynUser);                      //
+//                                                                                //
+// - Read the window of an array register into the client buffer. Only the        //
+//   elements in the window, up to the size of the client buffer, are requested   //
+//   to CPSW. They are read in chunks of up to arrayChunkSize elements, each one  //
+//   in its own transaction, so the workers and the other ports using the device  //
+//   are served between chunks; the requests queued to this port wait until the   //
+//   whole array is read (the asynchronous device support queues each chunk      //
+//   instead). The first chunk is then read again: if it changed, the array was   //
+//   updated during the transfer, and a MINOR READ alarm is set on the asyn user. //
+//   Changes which only touch the other chunks are not detected.                  //
+//   Called with the port lock taken.                                             //
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename V>
+size_t YCPSWASYN::readRegisterArray(YCPSWASYNRegister<T>& r, int list, V *value, size_t nElements, asynUser *pasynUser)
+{
+    size_t first, n, chunk;
+    size_t got = 0;
+
+    pasynUser->alarmStatus   = NO_ALARM;
+    pasynUser->alarmSeverity = NO_ALARM;
+
+    getArrayWindow(r, list, nElements, first, n);
+
+    if (n == 0)
+        return 0;
+
+    chunk = ( arrayChunkSize > 0 ) ? std::min(static_cast<size_t>(arrayChunkSize), n) : n;
+
+    for (size_t i = 0; i < n; i += chunk)
+    {
+        size_t               len = std::min(chunk, n - i);
+        IndexRange           range(first + i, first + i + len - 1);
+        YCPSWASYNTransaction t(this, r.dev);
+
+        try
+        {
+            got += getArray(r, value + i, len, &range);
+        }
+        catch (CPSWError &e)
+        {
+            t.fail(e);
+            throw;
+        }
+    }
+
+    if (chunk < n)
+    {
+        V          *check;
+        IndexRange range(first, first + chunk - 1);
+
+        r.check.resize(chunk * sizeof(V));
+        check = reinterpret_cast<V*>(&r.check[0]);
+
+        {
+            YCPSWASYNTransaction t(this, r.dev);
+
+            try
+            {
+                getArray(r, check, chunk, &range);
+            }
+            catch (CPSWError &e)
+            {
+                t.fail(e);
+                throw;
+            }
+        }
+
+        if (memcmp(check, value, chunk * sizeof(V)))
+        {
+            pasynUser->alarmStatus   = READ_ALARM;
+            pasynUser->alarmSeverity = MINOR_ALARM;
+            asynPrint(pasynUser, ASYN_TRACE_WARNING, "%s: port %s, array changed while it was read in chunks\n", driverName_, portName);
+        }
+    }
+
+    return got;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::initArrayRequest(YCPSWASYNArrayRequest *req,                   //
+//                                  const char *param);                           //
+//                                                                                //
+// - Attach a waveform record of the asynchronous device support to the array     //
+//   register of the parameter with the given name, on the parameter list         //
+//   req->addr. Integer registers can be read with any integer FTVL or DOUBLE,    //
+//   floating point registers only with DOUBLE.                                   //
+////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::initArrayRequest(YCPSWASYNArrayRequest *req, const char *param)
+{
+    asynParamType type;
+    bool          found    = false;
+    bool          floating = ( req->ftvl == menuFtypeDOUBLE );
+
+    if ( ( ! workers_ ) || ( req->addr < 0 ) || ( req->addr >= MAX_SIGNALS ) )
+        return false;
+
+    lock();
+
+    if ( ( findParam(req->addr, param, &req->function) == asynSuccess ) &&
+         ( getParamType(req->addr, req->function, &type) == asynSuccess ) &&
+         ( ( type == asynParamInt8Array ) || ( type == asynParamInt16Array ) ||
+           ( type == asynParamInt32Array ) || ( type == asynParamFloat64Array ) ) )
+    {
+        if (req->addr == DEV_REG_RO)
+            found = ro.contains(req->function);
+        else if (req->addr == DEV_REG_RW)
+            found = rw.contains(req->function);
+        else if (req->addr == DEV_FLOAT_RO)
+            found = floating && fo.contains(req->function);
+        else if (req->addr == DEV_FLOAT_RW)
+            found = floating && fw.contains(req->function);
+    }
+
+    unlock();
+
+    if (found)
+    {
+        req->drv = this;
+        req->buffer.resize(req->nelm * req->elementSize);
+    }
+
+    return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::queueArrayRequest(YCPSWASYNArrayRequest *req);                 //
+//                                                                                //
+// - Hand the array read of a waveform record to the worker pool, as a job for    //
+//   its first chunk. The window is taken from the :OFS and :LEN parameters of    //
+//   the register, as for the asyn clients.                                       //
+////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::queueArrayRequest(YCPSWASYNArrayRequest *req)
+{
+    YCPSWASYNDevice *dev;
+
+    req->done    = 0;
+    req->got     = 0;
+    req->checked = false;
+    req->changed = false;
+    req->status  = 0;
+    req->down    = false;
+
+    lock();
+
+    if (req->addr == DEV_REG_RO)
+    {
+        getArrayWindow(ro.at(req->function), req->addr, req->nelm, req->first, req->n);
+        dev = ro.at(req->function).dev;
+    }
+    else if (req->addr == DEV_REG_RW)
+    {
+        getArrayWindow(rw.at(req->function), req->addr, req->nelm, req->first, req->n);
+        dev = rw.at(req->function).dev;
+    }
+    else if (req->addr == DEV_FLOAT_RO)
+    {
+        getArrayWindow(fo.at(req->function), req->addr, req->nelm, req->first, req->n);
+        dev = fo.at(req->function).dev;
+    }
+    else
+    {
+        getArrayWindow(fw.at(req->function), req->addr, req->nelm, req->first, req->n);
+        dev = fw.at(req->function).dev;
+    }
+
+    if (req->n == 0)
+    {
+        unlock();
+        return false;
+    }
+
+    req->chunk = ( arrayChunkSize > 0 ) ? std::min(static_cast<size_t>(arrayChunkSize), req->n) : req->n;
+
+    workers_->queue(new YCPSWASYNArrayJob(req), workerKey(dev));
+
+    unlock();
+
+    return true;
+}
+
+template <typename T, typename V>
+void YCPSWASYN::readArrayChunk(YCPSWASYNRegister<T>& r, YCPSWASYNArrayRequest *req)
+{
+    V                    *value = reinterpret_cast<V*>(&req->buffer[0]);
+    YCPSWASYNDeviceGuard g(r.dev, LANE_LOW);
+
+    try
+    {
+        if (req->done < req->n)
+        {
+            size_t     len = std::min(req->chunk, req->n - req->done);
+            IndexRange range(req->first + req->done, req->first + req->done + len - 1);
+
+            req->got  += getArray(r, value + req->done, len, &range);
+            req->done += len;
+        }
+        else
+        {
+            IndexRange range(req->first, req->first + req->chunk - 1);
+
+            req->check.resize(req->chunk * sizeof(V));
+            getArray(r, reinterpret_cast<V*>(&req->check[0]), req->chunk, &range);
+
+            req->checked = true;
+            req->changed = ( memcmp(&req->check[0], value, req->chunk * sizeof(V)) != 0 );
+        }
+    }
+    catch (CPSWError &e)
+    {
+        g.fail(e);
+        throw;
+    }
+}
+
+template <typename T>
+void YCPSWASYN::readIntArrayChunk(YCPSWASYNRegister<T>& r, YCPSWASYNArrayRequest *req)
+{
+    switch (req->ftvl)
+    {
+        case menuFtypeCHAR:
+        case menuFtypeUCHAR:
+            readArrayChunk<T, epicsInt8>(r, req);
+            break;
+        case menuFtypeSHORT:
+        case menuFtypeUSHORT:
+            readArrayChunk<T, epicsInt16>(r, req);
+            break;
+        case menuFtypeLONG:
+        case menuFtypeULONG:
+            readArrayChunk<T, epicsInt32>(r, req);
+            break;
+        default:
+            readArrayChunk<T, epicsFloat64>(r, req);
+            break;
+    }
+}
+
+void YCPSWASYNArrayJob::run()
+{
+    request->drv->processArrayJob(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::processArrayJob(YCPSWASYNArrayJob *job);                       //
+//                                                                                //
+// - Read one chunk of an array read from a worker thread, holding the device     //
+//   lock only. The next chunk is queued as a new job on the low priority lane,   //
+//   behind the requests queued to the device in the meantime. Once all the       //
+//   chunks are read, the first one is read again the same way to detect a       //
+//   change during the transfer, and the record is processed again to complete   //
+//   the read.                                                                    //
+////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::processArrayJob(YCPSWASYNArrayJob *job)
+{
+    YCPSWASYNArrayRequest *req = job->request;
+    YCPSWASYNDevice       *dev = NULL;
+    std::string           error;
+    const char            *name = NULL;
+
+    static const char *functionName = "processArrayJob";
+
+    // The register tables don't change after initialization, so they can be read without the port lock
+    try
+    {
+        if (req->addr == DEV_REG_RO)
+        {
+            dev = ro.at(req->function).dev;
+            readIntArrayChunk(ro.at(req->function), req);
+        }
+        else if (req->addr == DEV_REG_RW)
+        {
+            dev = rw.at(req->function).dev;
+            readIntArrayChunk(rw.at(req->function), req);
+        }
+        else if (req->addr == DEV_FLOAT_RO)
+        {
+            dev = fo.at(req->function).dev;
+            readArrayChunk<DoubleVal_RO, epicsFloat64>(fo.at(req->function), req);
+        }
+        else
+        {
+            dev = fw.at(req->function).dev;
+            readArrayChunk<DoubleVal, epicsFloat64>(fw.at(req->function), req);
+        }
+    }
+    catch (CPSWError &e)
+    {
+        req->status = -1;
+        req->down   = ( dynamic_cast<YCPSWASYNDeviceDown*>(&e) != NULL );
+        error       = e.getInfo();
+    }
+
+    lock();
+
+    addLatency(job->lane, job->queued);
+
+    if ( ( req->status == 0 ) && ( ( req->done < req->n ) || ( ( req->chunk < req->n ) && !req->checked ) ) )
+    {
+        workers_->queue(new YCPSWASYNArrayJob(req), workerKey(dev));
+        unlock();
+        return;
+    }
+
+    if ( ( req->status != 0 ) && !req->down )
+    {
+        getParamName(req->addr, req->function, &name);
+        asynPrint(pasynUserSelf, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name ? name : "", error.c_str());
+    }
+    else if (req->changed)
+    {
+        asynPrint(pasynUserSelf, ASYN_TRACE_WARNING, "%s: port %s, array changed while it was read in chunks\n", driverName_, portName);
+    }
+
+    unlock();
+
+    callbackRequestProcessCallback(&req->callback, req->rec->prio, req->rec);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// size_t YCPSWASYN::writeRegisterArray(YCPSWASYNRegister<T>& r, int list,        //
+//                                      V *value, size_t nElements);              //
+//                                                                                //
+// - Write the client buffer into the window of an array register. Once the       //
+//   whole array has been written, its value is kept and later writes only send   //
+//   the span of elements that changed, or the whole window if none did. The      //
+//   kept value is dropped when a write fails, and when the generation of the     //
+//   device changes. The elements are written in chunks of up to arrayChunkSize   //
+//   elements, each one in its own transaction. Called with the port lock taken.  //
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename V>
+size_t YCPSWASYN::writeRegisterArray(YCPSWASYNRegister<T>& r, int list, V *value, size_t nElements)
+{
+    size_t first, n, from = 0, to, chunk;
+    size_t written = 0;
+    size_t nelms = r.reg->getNelms();
+    V      *committed = NULL;
+
+    getArrayWindow(r, list, nElements, first, n);
+
+    if (n == 0)
+        return 0;
+
+    to = n;
+
+    if ( ( r.committed.size() == nelms * sizeof(V) ) && ( r.committedGeneration == epicsAtomicGetIntT(&r.dev->generation) ) )
+    {
+        committed = reinterpret_cast<V*>(&r.committed[0]) + first;
+
+        // Nothing changed since the last write: the whole window is written again, as
+        // the client asked for a write and the hardware may not hold that value anymore
+        if (!changedSpan(value, committed, n, from, to))
+        {
+            from = 0;
+            to   = n;
+        }
+    }
+
+    chunk = ( arrayChunkSize > 0 ) ? static_cast<size_t>(arrayChunkSize) : to - from;
+
+    for (size_t i = from; i < to; i += chunk)
+    {
+        size_t               len = std::min(chunk, to - i);
+        IndexRange           range(first + i, first + i + len - 1);
+        YCPSWASYNTransaction t(this, r.dev);
+
+        try
+        {
+            written += setArray(r, value + i, len, &range);
+        }
+        catch (CPSWError &e)
+        {
+            // Part of the elements may have been written: the committed value is not known anymore
+            r.committed.clear();
+            t.fail(e);
+            throw;
+        }
+    }
+
+    if (committed)
+    {
+        memcpy(committed + from, value + from, ( to - from ) * sizeof(V));
+    }
+    else if ( ( first == 0 ) && ( n == nelms ) )
+    {
+        r.committed.assign(reinterpret_cast<uint8_t*>(value), reinterpret_cast<uint8_t*>(value + n));
+        r.committedGeneration = epicsAtomicGetIntT(&r.dev->generation);
+    }
+
+    return written;
+}
+
+//////////////////////////////////////////////
+// + Methods overridden from asynPortDriver //
+//////////////////////////////////////////////
+// These methods are called by asynPortDriver with the port lock already taken.
+// CPSW transactions are done inside a YCPSWASYNTransaction scope, which releases
+// the port lock while waiting for the hardware and holds the device lock instead.
+asynStatus YCPSWASYN::writeInt32(asynUser *pasynUser, epicsInt32 value)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "writeInt32";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (windowParams_[addr].count(function))
+            {
+                // Array window parameters are only kept on the parameter library
+                status = asynPortDriver::writeInt32(pasynUser, value);
+            }
+            else if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+
+                r.prefetched = false;  // A later read must not return the prefetched value
+
+                YCPSWASYNTransaction t(this, r.dev, LANE_HIGH);
+
+                try
+                {
+                    r.reg->setVal((uint32_t*)&value, 1);
+                }
+                catch (CPSWError &e)
+                {
+                    t.fail(e);
+                    throw;
+                }
+            }
+            else if (addr == DEV_CONFIG)
+            {
+                if (function == saveConfigValue_)
+                {
+                    saveConfiguration();
+                    callParamCallbacks(DEV_CONFIG);
+                }
+                else if (function == loadConfigValue_)
+                {
+                    loadConfiguration();
+                    callParamCallbacks(DEV_CONFIG);
+                }
+                else if (function == latencyResetValue_)
+                {
+                    resetLatency();
+                    callParamCallbacks(DEV_CONFIG);
+                }
+                else
+                    status = asynPortDriver::writeInt32(pasynUser, value);
+            }
+            else
+                status = asynPortDriver::writeInt32(pasynUser, value);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+
+        if (status == 0)
+        {
+            asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                        "%s:%s(%d), port %s parameter %s set to %d\n", \
+                        driverName_, functionName, function, this->portName, name, value);
+        }
+        else if (status != asynDisconnected)
+        {
+            asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                        "%s:%s(%d), port %s ERROR setting parameter %s to %d (status = %d)\n", \
+                        driverName_, functionName, function, this->portName, name, value, status);
+        }
+
+    }
+    else
+        status = asynPortDriver::writeInt32(pasynUser, value);
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readInt32(asynUser *pasynUser, epicsInt32 *value)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    uint32_t u32;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "readInt32";
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (windowParams_[addr].count(function))
+            {
+                status = getIntegerParam(addr, function, (int*)value);
+            }
+            else if (addr == DEV_REG_RO)
+            {
+                YCPSWASYNRegister<ScalVal_RO>& r = ro.at(function);
+                if (r.prefetched)
+                {
+                    // First read after the startup prefetch (e.g. PINI): return the prefetched value
+                    r.prefetched = false;
+                    status = getIntegerParam(addr, function, (int*)value);
+                }
+                else
+                {
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&u32, 1);
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    *value = (epicsInt32)u32;
+                    status = updateIntegerParam(addr, function, (int)u32);
+                }
+            }
+            else if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+                if (r.prefetched)
+                {
+                    r.prefetched = false;
+                    status = getIntegerParam(addr, function, (int*)value);
+                }
+                else
+                {
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&u32, 1);
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    *value = (epicsInt32)u32;
+                    status = updateIntegerParam(addr, function, (int)u32);
+                }
+            }
+            else if (addr == DEV_CONFIG)
+            {
+                status = getIntegerParam(addr, function, (int*)value);
+            }
+            else
+                status = asynPortDriver::readInt32(pasynUser, value);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readInt32(pasynUser, value);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s read %d from parameter %s\n", \
+                    driverName_, functionName, function, this->portName, *value, name);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+
+asynStatus YCPSWASYN::writeFloat64(asynUser *pasynUser, epicsFloat64 value)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "writeFloat64";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_FLOAT_RW)
+            {
+                YCPSWASYNRegister<DoubleVal>& r = fw.at(function);
+
+                r.prefetched = false;  // A later read must not return the prefetched value
+
+                YCPSWASYNTransaction t(this, r.dev, LANE_HIGH);
+
+                try
+                {
+                    r.reg->setVal((double*)&value, 1);
+                }
+                catch (CPSWError &e)
+                {
+                    t.fail(e);
+                    throw;
+                }
+            }
+            else
+                status = asynPortDriver::writeFloat64(pasynUser, value);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+
+        if (status == 0)
+        {
+            asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                        "%s:%s(%d), port %s parameter %s set to %f\n", \
+                        driverName_, functionName, function, this->portName, name, value);
+        }
+        else if (status != asynDisconnected)
+        {
+            asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                        "%s:%s(%d), port %s ERROR setting parameter %s to %f (status = %d)\n", \
+                        driverName_, functionName, function, this->portName, name, value, status);
+        }
+
+    }
+    else
+        status = asynPortDriver::writeFloat64(pasynUser, value);
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readFloat64(asynUser *pasynUser, epicsFloat64 *value)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    double val;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "readFloat64";
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_FLOAT_RO)
+            {
+                YCPSWASYNRegister<DoubleVal_RO>& r = fo.at(function);
+                if (r.prefetched)
+                {
+                    r.prefetched = false;
+                    status = getDoubleParam(addr, function, value);
+                }
+                else
+                {
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&val, 1);
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    *value = (epicsFloat64)val;
+                    status = updateDoubleParam(addr, function, val);
+                }
+            }
+            else if (addr == DEV_FLOAT_RW)
+            {
+                YCPSWASYNRegister<DoubleVal>& r = fw.at(function);
+                if (r.prefetched)
+                {
+                    r.prefetched = false;
+                    status = getDoubleParam(addr, function, value);
+                }
+                else
+                {
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&val, 1);
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    *value = (epicsFloat64)val;
+                    status = updateDoubleParam(addr, function, val);
+                }
+            }
+            else
+                status = asynPortDriver::readFloat64(pasynUser, value);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readFloat64(pasynUser, value);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s read %f from parameter %s\n", \
+                    driverName_, functionName, function, this->portName, *value, name);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::writeInt32Array(asynUser *pasynUser, epicsInt32 *value, size_t nElements)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    size_t n = 0;
+    const char *name;
+    static const char *functionName = "writeInt32Array";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+
+                // It was observed that for RW array registers, nElements = 0.
+                // In that case use the size of the register.
+                if (nElements == 0)
+                    nElements = r.reg->getNelms();
+
+                n = writeRegisterArray(r, addr, value, nElements);
+            }
+            else
+                status = asynPortDriver::writeInt32Array(pasynUser, value, nElements);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeInt32Array(pasynUser, value, nElements);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, n);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+
+}
+
+asynStatus YCPSWASYN::readInt32Array(asynUser *pasynUser, epicsInt32 *value, size_t nElements, size_t *nIn)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+    static const char *functionName = "readInt32Array";
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RO)
+                *nIn = readRegisterArray(ro.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_REG_RW)
+                *nIn = readRegisterArray(rw.at(function), addr, value, nElements, pasynUser);
+            else
+                status = asynPortDriver::readInt32Array(pasynUser, value, nElements, nIn);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readInt32Array(pasynUser, value, nElements, nIn);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s got parameter %s, requested = %zu, got = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR getting  parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::writeInt8Array(asynUser *pasynUser, epicsInt8 *value, size_t nElements)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    size_t n = 0;
+    const char *name;
+    static const char *functionName = "writeInt8Array";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RW)
+                n = writeRegisterArray(rw.at(function), addr, value, nElements);
+            else
+                status = asynPortDriver::writeInt8Array(pasynUser, value, nElements);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeInt8Array(pasynUser, value, nElements);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, n);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readInt8Array(asynUser *pasynUser, epicsInt8 *value, size_t nElements, size_t *nIn)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+    static const char *functionName = "readInt8Array";
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RO)
+                *nIn = readRegisterArray(ro.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_REG_RW)
+                *nIn = readRegisterArray(rw.at(function), addr, value, nElements, pasynUser);
+            else
+                status = asynPortDriver::readInt8Array(pasynUser, value, nElements, nIn);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readInt8Array(pasynUser, value, nElements, nIn);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s got parameter %s, requested = %zu, got = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR getting  parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::writeInt16Array(asynUser *pasynUser, epicsInt16 *value, size_t nElements)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    size_t n = 0;
+    const char *name;
+    static const char *functionName = "writeInt16Array";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RW)
+                n = writeRegisterArray(rw.at(function), addr, value, nElements);
+            else
+                status = asynPortDriver::writeInt16Array(pasynUser, value, nElements);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeInt16Array(pasynUser, value, nElements);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, n);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readInt16Array(asynUser *pasynUser, epicsInt16 *value, size_t nElements, size_t *nIn)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+    static const char *functionName = "readInt16Array";
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RO)
+                *nIn = readRegisterArray(ro.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_REG_RW)
+                *nIn = readRegisterArray(rw.at(function), addr, value, nElements, pasynUser);
+            else
+                status = asynPortDriver::readInt16Array(pasynUser, value, nElements, nIn);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readInt16Array(pasynUser, value, nElements, nIn);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s got parameter %s, requested = %zu, got = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR getting  parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readOctet(asynUser *pasynUser, char *value, size_t maxChars, size_t *nActual, int *eomReason)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+    static const char *functionName = "readOctet";
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            // Octet registers are 8-bit wide, so they are read directly into the client buffer
+            if (addr == DEV_REG_RO)
+            {
+                YCPSWASYNRegister<ScalVal_RO>& r = ro.at(function);
+                YCPSWASYNTransaction           t(this, r.dev);
+
+                try
+                {
+                    *nActual = r.reg->getVal(reinterpret_cast<uint8_t*>(value), maxChars);
+                }
+                catch (CPSWError &e)
+                {
+                    t.fail(e);
+                    throw;
+                }
+            }
+            else if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+                YCPSWASYNTransaction        t(this, r.dev);
+
+                try
+                {
+                    *nActual = r.reg->getVal(reinterpret_cast<uint8_t*>(value), maxChars);
+                }
+                catch (CPSWError &e)
+                {
+                    t.fail(e);
+                    throw;
+                }
+            }
+            else
+                status = asynPortDriver::readOctet(pasynUser, value, maxChars, nActual, eomReason);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readOctet(pasynUser, value, maxChars, nActual, eomReason);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s maxChars = %zu, nActual = %zu, eomReason %d\n", \
+                    driverName_, functionName, function, this->portName, maxChars, *nActual, *eomReason);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR getting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, maxChars, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::writeOctet (asynUser *pasynUser, const char *value, size_t maxChars, size_t *nActual)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+    static const char *functionName = "writeOctet";
+    this->getAddress(pasynUser, &addr);
+    IndexRange range(0, maxChars-1);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+                {
+                    YCPSWASYNTransaction t(this, r.dev, LANE_HIGH);
+
+                    try
+                    {
+                        *nActual = (size_t)r.reg->setVal((uint8_t*)value, maxChars, &range);
+                    }
+                    catch (CPSWError &e)
+                    {
+                        t.fail(e);
+                        throw;
+                    }
+                }
+                if (*nActual <= 0)
+                        status = -1;
+            }
+            else if (addr == DEV_CONFIG)
+            {
+                if (function == saveConfigFileValue_)
+                {
+                    saveConfigFileName = std::string(value);
+                    *nActual = maxChars;
+                    status = setStringParam(DEV_CONFIG, saveConfigFileValue_, value);
+                }
+                else if (function == loadConfigFileValue_)
+                {
+                    loadConfigFileName = std::string(value);
+                    *nActual = maxChars;
+                    status = setStringParam(DEV_CONFIG, loadConfigFileValue_, value);
+                }
+                else if (function == loadConfigRootValue_)
+                {
+                    loadConfigRootPath = std::string(value);
+                    *nActual = maxChars;
+                    status = setStringParam(DEV_CONFIG, loadConfigRootValue_, value);
+                }
+                else if (function == saveConfigRootValue_)
+                {
+                    saveConfigRootPath = std::string(value);
+                    *nActual = maxChars;
+                    status = setStringParam(DEV_CONFIG, saveConfigRootValue_, value);
+                }
+                else
+                    status = asynPortDriver::writeOctet(pasynUser, value, maxChars, nActual);
+
+                callParamCallbacks(DEV_CONFIG);
+            }
+            else
+                status = asynPortDriver::writeOctet(pasynUser, value, maxChars, nActual);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeOctet(pasynUser, value, maxChars, nActual);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, maxChars, *nActual);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, maxChars, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+
+asynStatus YCPSWASYN::readFloat64Array(asynUser *pasynUser, epicsFloat64 *value, size_t nElements, size_t *nIn)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    this->getAddress(pasynUser, &addr);
+    const char *name;
+
+    static const char *functionName = "readFloat64Array";
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_FLOAT_RO)
+                *nIn = readRegisterArray(fo.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_FLOAT_RW)
+                *nIn = readRegisterArray(fw.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_REG_RO)
+                *nIn = readRegisterArray(ro.at(function), addr, value, nElements, pasynUser);
+            else if (addr == DEV_REG_RW)
+                *nIn = readRegisterArray(rw.at(function), addr, value, nElements, pasynUser);
+            else
+                status = asynPortDriver::readFloat64Array(pasynUser, value, nElements, nIn);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readFloat64Array(pasynUser, value, nElements, nIn);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s get parameter %s. Requested = %zu, got = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, *nIn);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR getting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+
+}
+
+asynStatus YCPSWASYN::writeFloat64Array(asynUser *pasynUser, epicsFloat64 *value, size_t nElements)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    size_t n = 0;
+    this->getAddress(pasynUser, &addr);
+    const char *name;
+
+    static const char *functionName = "writeFloat64Array";
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_FLOAT_RW)
+                n = writeRegisterArray(fw.at(function), addr, value, nElements);
+            else if (addr == DEV_REG_RW)
+                n = writeRegisterArray(rw.at(function), addr, value, nElements);
+            else
+                status = asynPortDriver::writeFloat64Array(pasynUser, value, nElements);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeFloat64Array(pasynUser, value, nElements);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s set new content on parameter %s. Requested = %zu, written = %zu\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, n);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, nElements, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::writeUInt32Digital(asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "writeUInt32Digital";
+
+    this->getAddress(pasynUser, &addr);
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+                uint32_t                    u32;
+
+                r.prefetched = false;  // A later read must not return the prefetched value
+
+                // Only the bits of the mask are written; the others keep the value of the word
+                registerWord(r);
+
+                {
+                    YCPSWASYNTransaction t(this, r.dev, LANE_HIGH);
+
+                    try
+                    {
+                        u32 = commitRegisterWord(r, value, mask);
+                    }
+                    catch (CPSWError &e)
+                    {
+                        t.fail(e);
+                        throw;
+                    }
+                }
+
+                // Kept for the read-back records
+                updateUIntDigitalParam(addr, function, u32, 0xFFFFFFFF);
+            }
+            else if(addr == DEV_CMD)
+            {
+                // Throws if there is no command on this parameter
+                cmd.at(function);
+
+                YCPSWASYNCommandStatus& cs = commandStatus_[function];
+
+                if (cs.busy)
+                {
+                    status = -1;
+                    asynPrint(pasynUser, ASYN_TRACE_ERROR, "%s:%s(%d), port %s command %s is still running\n", \
+                        driverName_, functionName, function, this->portName, name);
+                }
+                else
+                {
+                    // Run the command on the command executor. Its parameters report when it is done.
+                    cs.busy = true;
+                    setIntegerParam(DEV_CMD, cs.busyParam, 1);
+                    setUIntDigitalParam(DEV_CMD, function, 1, 0xFFFFFFFF);
+                    callParamCallbacks(DEV_CMD, DEV_CMD);
+
+                    commandExecutor_->queue(new YCPSWASYNRegisterJob(this, JOB_EXECUTE_COMMAND, addr, function), 0);
+                }
+            }
+            else
+                status = asynPortDriver::writeUInt32Digital(pasynUser, value, mask);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::writeUInt32Digital(pasynUser, value, mask);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s parameter %s set to %d\n", \
+                    driverName_, functionName, function, this->portName, name, value);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR setting parameter %s to %d (status = %d)\n", \
+                    driverName_, functionName, function, this->portName, name, value, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::readUInt32Digital(asynUser *pasynUser, epicsUInt32 *value, epicsUInt32 mask)
+{
+    int addr;
+    int function = pasynUser->reason;
+    int status=0;
+    uint32_t u32;
+    const char *name;
+
+    this->getAddress(pasynUser, &addr);
+
+    static const char *functionName = "readUInt32Digital";
+
+    if (!getParamName(addr, function, &name))
+    {
+        try
+        {
+            if (addr == DEV_REG_RO)
+            {
+                YCPSWASYNRegister<ScalVal_RO>& r = ro.at(function);
+                if (r.prefetched)
+                {
+                    r.prefetched = false;
+                    status = getUIntDigitalParam(addr, function, value, mask);
+                }
+                else if (r.group)
+                {
+                    readFieldGroup(r.group);
+                    status = getUIntDigitalParam(addr, function, value, mask);
+                }
+                else
+                {
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&u32, 1);
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    u32 &= mask;
+                    *value = (epicsInt32)u32;
+                    status = updateUIntDigitalParam(addr, function, (epicsUInt32)u32, mask);
+                }
+            }
+            else if (addr == DEV_REG_RW)
+            {
+                YCPSWASYNRegister<ScalVal>& r = rw.at(function);
+                if (r.prefetched)
+                {
+                    r.prefetched = false;
+                    status = getUIntDigitalParam(addr, function, value, mask);
+                }
+                else
+                {
+                    YCPSWASYNRegisterWord *w = registerWord(r);
+
+                    {
+                        YCPSWASYNTransaction t(this, r.dev);
+
+                        try
+                        {
+                            r.reg->getVal(&u32, 1);
+                            w->keep(u32, epicsAtomicGetIntT(&r.dev->generation));
+                        }
+                        catch (CPSWError &e)
+                        {
+                            t.fail(e);
+                            throw;
+                        }
+                    }
+                    u32 &= mask;
+                    *value = (epicsInt32)u32;
+                    status = updateUIntDigitalParam(addr, function, (epicsUInt32)u32, mask);
+                }
+            }
+            else if (addr == DEV_CMD)
+            {
+                // 1 while the command is running
+                status = getUIntDigitalParam(addr, function, value, mask);
+            }
+            else if (addr == DEV_CONFIG)
+            {
+                status = getUIntDigitalParam(addr, function, value, mask);
+            }
+
+            else
+                status = asynPortDriver::readUInt32Digital(pasynUser, value, mask);
+        }
+        catch (CPSWError &e)
+        {
+            status = reportError(pasynUser, functionName, name, e);
+        }
+    }
+    else
+        status = asynPortDriver::readUInt32Digital(pasynUser, value, mask);
+
+    if (status == 0)
+    {
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s read %d from parameter %s\n", \
+                    driverName_, functionName, function, this->portName, *value, name);
+    }
+    else if (status != asynDisconnected)
+    {
+        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
+                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
+                            driverName_, functionName, function, this->portName, name, status);
+    }
+
+    return (status==0) ? asynSuccess : asynError;
+}
+
+asynStatus YCPSWASYN::getBounds(asynUser *pasynUser, epicsInt32 *low, epicsInt32 *high)
+{
+    int addr;
+    int status = 0;
+    int function = pasynUser->reason;
+    this->getAddress(pasynUser, &addr);
+    const char *name;
+    static const char *functionName = "getBounds";
+
+    if (!getParamName(addr, function, &name))
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
+                    "%s:%s(%d), port %s getRegister %s\n", \
+                    driverName_, functionName, function, this->portName, name);
+
+    status = asynPortDriver::getBounds(pasynUser, low, high);
+
+    return (status==0) ? asynSuccess : asynError;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// bool YCPSWASYN::addPathFilter(const std::string& action,                        //
+//                               const std::string& pattern)                       //
+// bool YCPSWASYN::pathMatches(const YCPSWASYNPathFilter& f,                       //
+//                             const std::string& path)                            //
+// - Path filters of the auto-generation. Glob patterns must match the whole path  //
+//   ('*' also matches '/'); regular expressions match any part of it.             //
+/////////////////////////////////////////////////////////////////////////////////////
+bool YCPSWASYN::addPathFilter(const std::string& action, const std::string& pattern)
+{
+    YCPSWASYNPathFilter f;
+    std::size_t         prefixLength = strlen(PATH_FILTER_REGEX_PREFIX);
+
+    if ( ( action != "include" ) && ( action != "exclude" ) )
+    {
+        fprintf( stderr, "Error: Invalid filter action \"%s\". It must be \"include\" or \"exclude\"\n", action.c_str() );
+        return false;
+    }
+
+    if ( pattern.empty() || ( pattern == PATH_FILTER_REGEX_PREFIX ) )
+    {
+        fprintf( stderr, "Error: Empty filter pattern\n" );
+        return false;
+    }
+
+    f.include = ( action == "include" );
+    f.pattern = pattern;
+    f.re      = NULL;
+
+    // The regular expressions are kept for the life of the IOC
+    if ( 0 == pattern.compare(0, prefixLength, PATH_FILTER_REGEX_PREFIX) )
+    {
+        char errorMessage[256];
+        int  status;
+
+        f.re = new regex_t;
+        if ( ( status = regcomp(f.re, pattern.c_str() + prefixLength, REG_EXTENDED | REG_NOSUB) ) )
+        {
+            regerror(status, f.re, errorMessage, sizeof(errorMessage));
+            fprintf( stderr, "Error: Invalid regular expression \"%s\": %s\n", pattern.c_str() + prefixLength, errorMessage );
+            delete f.re;
+            return false;
+        }
+    }
+
+    pathFilters.push_back(f);
+
+    return true;
+}
+
+bool YCPSWASYN::pathMatches(const YCPSWASYNPathFilter& f, const std::string& path)
+{
+    if (f.re)
+        return ( 0 == regexec(f.re, path.c_str(), 0, NULL, 0) );
+
+    return ( 0 == fnmatch(f.pattern.c_str(), path.c_str(), 0) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// std::string YCPSWASYN::debugFilePrefix(void)                                    //
+// - Prefix of the debug information files of this port                            //
+//                                                                                 //
+/////////////////////////////////////////////////////////////////////////////////////
+std::string YCPSWASYN::debugFilePrefix(void)
+{
+    std::string pre = debugFilePath + std::string(this->portName_) + "_";
+
+    if ( recordPrefix_.length() > 0 )
+        pre += recordPrefix_ + "_";
+
+    return pre;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::printStartupProfile(FILE *fp)                                   //
+// void YCPSWASYN::writeStartupProfile(void)                                       //
+// - Print the time spent on each startup phase, and write it in JSON format next  //
+//   to the PV list dump. The file is written again once iocInit is done. Some     //
+//   phases are nested in others (e.g. records in dictionary), so the total is     //
+//   timed on its own. iocInit is shared by all ports, and is not in the total.    //
+/////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::printStartupProfile(FILE *fp)
+{
+    fprintf(fp, "    %-14s %12s %12s %10s\n", "Phase", "Wall (s)", "CPU (s)", "Count");
+    for (int i = 0; i < PHASE_IOC_INIT; ++i)
+        fprintf(fp, "    %-14s %12.6f %12.6f %10lu\n", startupPhaseNames[i], phases_[i].wall, phases_[i].cpu, phases_[i].count);
+    fprintf(fp, "    %-14s %12.6f %12.6f\n", "Total", total_.wall, total_.cpu);
+    if (phases_[PHASE_IOC_INIT].count)
+        fprintf(fp, "    %-14s %12.6f %12.6f    (all ports)\n", startupPhaseNames[PHASE_IOC_INIT],
+            phases_[PHASE_IOC_INIT].wall, phases_[PHASE_IOC_INIT].cpu);
+}
+
+void YCPSWASYN::writeStartupProfile(void)
+{
+    std::string       fileName = debugFilePrefix() + STARTUP_PROFILE_FILE_NAME;
+    YCPSWASYNRAIIFile file(fileName, "w");
+
+    if (!file.f())
+    {
+        fprintf(stderr, "Error: Startup profile \"%s\" not written\n", fileName.c_str());
+        return;
+    }
+
+    file.write("{\n  \"port\": \"%s\",\n  \"recordPrefix\": \"%s\",\n  \"phases\": {\n", portName_, recordPrefix_.c_str());
+    for (int i = 0; i < PHASE_IOC_INIT; ++i)
+    {
+        file.write("    \"%s\": { \"wall\": %.6f, \"cpu\": %.6f, \"count\": %lu }%s\n", startupPhaseNames[i],
+            phases_[i].wall, phases_[i].cpu, phases_[i].count, ( i < PHASE_IOC_INIT - 1 ) ? "," : "");
+    }
+    file.write("  },\n  \"total\": { \"wall\": %.6f, \"cpu\": %.6f },\n", total_.wall, total_.cpu);
+    file.write("  \"%s\": { \"wall\": %.6f, \"cpu\": %.6f, \"count\": %lu }\n}\n", startupPhaseNames[PHASE_IOC_INIT],
+        phases_[PHASE_IOC_INIT].wall, phases_[PHASE_IOC_INIT].cpu, phases_[PHASE_IOC_INIT].count);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// void YCPSWASYN::startupInitHook(initHookState state)                            //
+// - Time iocInit, which is shared by all ports, and add it to their profiles      //
+//                                                                                 //
+/////////////////////////////////////////////////////////////////////////////////////
+void YCPSWASYN::startupInitHook(initHookState state)
+{
+    if (state == initHookAtBeginning)
+    {
+        if ( ! deferredPorts_.empty() )
+            fprintf(stderr, "Error: %zu YCPSWASYN ports were not initialized. YCPSWASYNInitPorts must be called before iocInit.\n",
+                deferredPorts_.size());
+
+        delete iocInitTimer_;
+        iocInitPhase_ = YCPSWASYNPhaseStats();
+        iocInitTimer_ = new YCPSWASYNPhaseTimer(iocInitPhase_);
+    }
+    else if ( ( state == initHookAfterIocRunning ) && iocInitTimer_ )
+    {
+        delete iocInitTimer_;
+        iocInitTimer_ = NULL;
+
+        for (std::size_t i = 0; i < ports_.size(); ++i)
+        {
+            ports_[i]->phases_[PHASE_IOC_INIT] = iocInitPhase_;
+            ports_[i]->writeStartupProfile();
+        }
+    }
+}
+
+void YCPSWASYN::report(FILE *fp, int details)
+{
+    fprintf(fp, "  Port: %s\n", this->portName);
+
+    if (details > 0)
+    {
+        fprintf(fp, "  Register tables:\n");
+        fprintf(fp, "    %-14s %10s %10s %12s\n", "Interface", "Registers", "Slots", "Bytes");
+        fprintf(fp, "    %-14s %10zu %10zu %12zu\n", "ScalVal_RO",   ro.count(),  ro.slots(),  ro.memUsage());
+        fprintf(fp, "    %-14s %10zu %10zu %12zu\n", "ScalVal",      rw.count(),  rw.slots(),  rw.memUsage());
+        fprintf(fp, "    %-14s %10zu %10zu %12zu\n", "DoubleVal_RO", fo.count(),  fo.slots(),  fo.memUsage());
+        fprintf(fp, "    %-14s %10zu %10zu %12zu\n", "DoubleVal",    fw.count(),  fw.slots(),  fw.memUsage());
+        fprintf(fp, "    %-14s %10zu %10zu %12zu\n", "Command",      cmd.count(), cmd.slots(), cmd.memUsage());
+        fprintf(fp, "    %-14s %10s %10s %12zu\n",   "Total", "", "",
+                ro.memUsage() + rw.memUsage() + fo.memUsage() + fw.memUsage() + cmd.memUsage());
+        if (lazyInterfaces)
+            fprintf(fp, "  Registers not accessed yet (interface not created): %zu\n",
+                ro.deferred() + rw.deferred() + fo.deferred() + fw.deferred() + cmd.deferred());
+        fprintf(fp, "  Number of devices (each with its own lock): %zu\n", devices_.size());
+        for (std::map<std::string, YCPSWASYNDevice*>::iterator it = devices_.begin(); it != devices_.end(); ++it)
+        {
+            if (epicsAtomicGetIntT(&it->second->tripped))
+            {
+                YCPSWASYNDevice *dev = it->second;
+
+                fprintf(fp, "    Not reachable: %s (%d requests failed), probe register: %s\n", it->first.c_str(), epicsAtomicGetIntT(&dev->failedRequests),
+                    dev->probe ? dev->probe->getPath()->toString().c_str() :
+                    dev->probeDouble ? dev->probeDouble->getPath()->toString().c_str() : "none (the next request is tried)");
+            }
+        }
+        if (workers_)
+            fprintf(fp, "  Asynchronous register access workers: %zu (I/O Intr poll period: %f s, 0 = no poll)\n", workers_->size(), asyncPollPeriod);
+        fprintf(fp, "  Enum array field groups (read with one transaction): %zu\n", fieldGroups_.size());
+        {
+            epicsGuard<epicsMutex> g(leafClassLock_);
+            fprintf(fp, "  Register fields probed: %zu (CPSW exceptions avoided: %lu)\n", leafClasses_.size(), exceptionsAvoided_);
+        }
+        fprintf(fp, "  Request latency:\n");
+        fprintf(fp, "    %-14s %10s %12s %12s\n", "Lane", "Requests", "Mean (s)", "Max (s)");
+        for (int i = 0; i < LANE_SIZE; ++i)
+            fprintf(fp, "    %-14s %10ld %12.6f %12.6f\n", laneNames[i], latency_[i].count,
+                latency_[i].count ? latency_[i].sum / latency_[i].count : 0.0, latency_[i].max);
+        if (shards_.size() > 1)
+        {
+            fprintf(fp, "  Shards (key mode: %s):\n", (shardKeyMode == SHARD_KEY_DEVICE) ? "device" : "subtree");
+            for (std::size_t i = 0; i < shards_.size(); ++i)
+                fprintf(fp, "    %-20s %10zu registers\n", shards_[i]->portName,
+                    shards_[i]->ro.count() + shards_[i]->rw.count() + shards_[i]->fo.count() +
+                    shards_[i]->fw.count() + shards_[i]->cmd.count());
+        }
+        // Shards don't have a startup of their own
+        if (phases_[PHASE_INIT].count)
+        {
+            fprintf(fp, "  Startup profile:\n");
+            printStartupProfile(fp);
+        }
+    }
+
+    asynPortDriver::report(fp, details);
+}
+
+YCPSWASYNPhaseTimer::YCPSWASYNPhaseTimer(YCPSWASYNPhaseStats& stats)
+:
+    stats_(stats),
+    cpuStart_(cpuSeconds()),
+    count_(1),
+    running_(true)
+{
+    epicsTimeGetCurrent(&wallStart_);
+}
+
+YCPSWASYNPhaseTimer::~YCPSWASYNPhaseTimer()
+{
+    stop();
+}
+
+void YCPSWASYNPhaseTimer::stop()
+{
+    if (!running_)
+        return;
+
+    epicsTimeStamp now;
+    epicsTimeGetCurrent(&now);
+
+    stats_.wall  += epicsTimeDiffInSeconds(&now, &wallStart_);
+    stats_.cpu   += cpuSeconds() - cpuStart_;
+    stats_.count += count_;
+    running_      = false;
+}
+
+double YCPSWASYNPhaseTimer::cpuSeconds()
+{
+    struct timespec t;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t))
+        return 0.0;
+
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+YCPSWASYNTransaction::YCPSWASYNTransaction(YCPSWASYN *drv, YCPSWASYNDevice *dev, int lane)
+:
+    drv_(drv),
+    dev_(dev),
+    lane_(lane),
+    result_(RESULT_SUCCESS)
+{
+    // Requests to a device which is not reachable fail right away, keeping the port lock
+    if (dev_)
+        dev_->checkReachable();
+
+    epicsTimeGetCurrent(&start_);
+
+    drv_->unlock();
+    if (dev_)
+        dev_->acquire(lane_);
+}
+
+YCPSWASYNTransaction::~YCPSWASYNTransaction()
+{
+    if (dev_)
+        dev_->release(result_);
+    drv_->lock();
+
+    if (dev_)
+        drv_->addLatency(lane_, start_);
+}
+
+YCPSWASYNConfigTransaction::YCPSWASYNConfigTransaction(YCPSWASYN *drv, bool load)
+:
+    drv_(drv),
+    load_(load)
+{
+    for (std::size_t i = 0; i < drv_->shards_.size(); ++i)
+    {
+        std::map<std::string, YCPSWASYNDevice*>& devices = drv_->shards_[i]->devices_;
+
+        for (std::map<std::string, YCPSWASYNDevice*>::iterator it = devices.begin(); it != devices.end(); ++it)
+            devs_.insert(it->second);
+    }
+
+    drv_->unlock();
+
+    for (std::set<YCPSWASYNDevice*>::iterator it = devs_.begin(); it != devs_.end(); ++it)
+        (*it)->acquire(LANE_HIGH);
+}
+
+YCPSWASYNConfigTransaction::~YCPSWASYNConfigTransaction()
+{
+    for (std::set<YCPSWASYNDevice*>::reverse_iterator it = devs_.rbegin(); it != devs_.rend(); ++it)
+    {
+        // The registers were written outside of the driver
+        if (load_)
+            epicsAtomicIncrIntT(&(*it)->generation);
+
+        (*it)->release(RESULT_NONE);
+    }
+
+    drv_->lock();
+}
+
+YCPSWASYNWorkerPool::YCPSWASYNWorkerPool(const std::string& name, int nWorkers)
+{
+    for (int i = 0; i < nWorkers; ++i)
+    {
+        std::stringstream threadName;
+        threadName << name << "_W" << i;
+
+        Worker *w = new Worker();
+        workers_.push_back(w);
+
+        if ( ! epicsThreadCreate(threadName.str().c_str(), epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)YCPSWASYNWorkerPool::workerTask, w) )
+            printf("ERROR: Unable to create worker thread %s\n", threadName.str().c_str());
+    }
+}
+
+void YCPSWASYNWorkerPool::queue(YCPSWASYNJob *job, size_t key)
+{
+    Worker *w = workers_.at(key % workers_.size());
+
+    epicsTimeGetCurrent(&job->queued);
+
+    {
+        epicsGuard<epicsMutex> g(w->lock);
+        w->jobs[job->lane].push_back(job);
+    }
+
+    w->event.signal();
+}
+
+void YCPSWASYNWorkerPool::workerTask(void *arg)
+{
+    Worker *w = static_cast<Worker*>(arg);
+
+    for(;;)
+    {
+        YCPSWASYNJob *job = NULL;
+
+        {
+            epicsGuard<epicsMutex> g(w->lock);
+
+            // Lanes are served in priority order
+            for (int i = 0; ( i < LANE_SIZE ) && !job; ++i)
+            {
+                if (!w->jobs[i].empty())
+                {
+                    job = w->jobs[i].front();
+                    w->jobs[i].pop_front();
+                }
+            }
+        }
+
+        if (!job)
+        {
+            w->event.wait();
+            continue;
+        }
+
+        job->run();
+        delete job;
+    }
+}
+
+YCPSWASYNRAIIFile::YCPSWASYNRAIIFile(const std::string &name, const char *mode)
+    :
+    name_(name)
+{
+    if ( ! (f_ = fopen( name.c_str(), mode )) )
+    {
+        printf("ERROR: Unable to open file: %s\n", name.c_str());
+    }
+}
+
+void YCPSWASYNRAIIFile::write(const char * format, ...)
+{
+    va_list args;
+
+    if (f_ != NULL)
+    {
+        va_start(args, format);
+        vfprintf(f_, format, args);
+        va_end(args);
+    }
+}
+
+YCPSWASYNRAIIFile::~YCPSWASYNRAIIFile()
+{
+    if (f_ != NULL)
+        fclose( f_ );
+}
+
+YCPSWASYNGenerateDB::YCPSWASYNGenerateDB(const std::string &pre, YCPSWASYN *drv)
+    :
+    drv_   ( drv ),
+    indent_( 0   ),
+    textFile( YCPSWASYNRAIIFile( pre + REG_DUMP_TEXT_FILE_NAME, "w" ) ),
+    yaml_  ( 1   ),
+    next_  ( 0   ),
+    running_( 0  ),
+    filtered_( 0 ),
+    yamlFile( YCPSWASYNRAIIFile( pre + REG_DUMP_YAML_FILE_NAME, "w" ) )
+
+{
+}
+
+YCPSWASYNGenerateDB::~YCPSWASYNGenerateDB()
+{
+    for (std::size_t i = 0; i < yaml_.size(); ++i)
+        yamlFile.write("%s", yaml_[i].c_str());
+}
+
+void YCPSWASYNGenerateDB::yamlWrite(const char *format, ...)
+{
+    char    buf[512];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    yaml_.back() += buf;
+}
+
+bool YCPSWASYNGenerateDB::visitPre(ConstPath p)
+{
+    std::string rep = p->toString();
+    const char *lst = strrchr( rep.c_str(), '/' );
+
+    // Filtered paths are left out of the dumps, and their children are not explored
+    if ( filtered( rep, ! p->tail()->isHub() ) )
+    {
+        ++filtered_;
+        pushYamlIndent();
+        return false;
+    }
+
+    lst = lst ? lst + 1 : rep.c_str();
+    yamlWrite("%*s%s:", yamlIndent(), "", lst);
+    if ( ! p->tail()->isHub() )
+    {
+        // The register is created once the interfaces of all registers are attached.
+        // Its interface types go on a segment of their own in the YAML dump.
+        YCPSWASYNLeaf leaf;
+        leaf.p       = p->clone();
+        leaf.segment = yaml_.size();
+        leaves_.push_back(leaf);
+
+        yaml_.push_back(std::string());
+        yaml_.push_back(std::string());
+
+        textFile.write("%s\n", p->toString().c_str());
+    }
+    yamlWrite("\n");
+    pushYamlIndent();
+    return true;
+}
+
+void YCPSWASYNGenerateDB::discover()
+{
+    int nThreads = std::min(YCPSWASYN::discoveryThreads, static_cast<int>(leaves_.size()));
+
+    if (nThreads <= 1)
+    {
+        for (std::size_t i = 0; i < leaves_.size(); ++i)
+            YCPSWASYN::createInterfaces(leaves_[i].p, leaves_[i].ifs);
+        return;
+    }
+
+    next_    = 0;
+    running_ = nThreads;
+
+    for (int i = 0; i < nThreads; ++i)
+    {
+        std::stringstream threadName;
+        threadName << "YCPSWASYN_D" << i;
+
+        if ( ! epicsThreadCreate(threadName.str().c_str(), epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackMedium), (EPICSTHREADFUNC)YCPSWASYNGenerateDB::discoveryTask, this) )
+        {
+            printf("ERROR: Unable to create discovery thread %s\n", threadName.str().c_str());
+
+            if (epicsAtomicDecrIntT(&running_) == 0)
+                done_.signal();
+        }
+    }
+
+    done_.wait();
+
+    // Registers left by threads which could not be created
+    for (size_t i = epicsAtomicGetIntT(&next_); i < leaves_.size(); ++i)
+        YCPSWASYN::createInterfaces(leaves_[i].p, leaves_[i].ifs);
+}
+
+void YCPSWASYNGenerateDB::discoveryTask(void *arg)
+{
+    YCPSWASYNGenerateDB *g = static_cast<YCPSWASYNGenerateDB*>(arg);
+    size_t              i;
+
+    while ( ( i = epicsAtomicIncrIntT(&g->next_) - 1 ) < g->leaves_.size() )
+        YCPSWASYN::createInterfaces(g->leaves_[i].p, g->leaves_[i].ifs);
+
+    if (epicsAtomicDecrIntT(&g->running_) == 0)
+        g->done_.signal();
+}
+
+void YCPSWASYNGenerateDB::visitPost(ConstPath p)
+{
+    included_.pop_back();
+    popYamlIndent();
+}
+
+bool YCPSWASYNGenerateDB::filtered(const std::string& path, bool leaf)
+{
+    const std::vector<YCPSWASYNPathFilter>& filters = YCPSWASYN::pathFilters;
+    bool                                    included = ( ! included_.empty() ) && included_.back();
+    bool                                    includes = false;
+
+    for (std::size_t i = 0; i < filters.size(); ++i)
+    {
+        if (filters[i].include)
+        {
+            includes = true;
+            if ( ( ! included ) && YCPSWASYN::pathMatches(filters[i], path) )
+                included = true;
+        }
+        else if ( YCPSWASYN::pathMatches(filters[i], path) )
+        {
+            // Exclude filters take precedence
+            included_.push_back(false);
+            return true;
+        }
+    }
+
+    // Without include filters, everything not excluded is included
+    included = included || ( ! includes );
+    included_.push_back(included);
+
+    // Hubs are explored, as their children can still be included
+    return leaf && ( ! included );
+}
+
+void YCPSWASYNGenerateDB::processStack(unsigned level)
+{
+    unsigned i, t;
+
+    if  ( pathStack_[level]->empty() )
+    {
+        // Process empty paths, (i.e. paths starting at root)
+        pathStack_[level]->explore( this );
     }
     else
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR setting parameter %s. Requested = %zu (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, nElements, status);
+        for ( i = pathStack_[level]->getTailFrom(); i <= (t = pathStack_[level]->getTailTo()); i++ )
+        {
+            if ( pathStack_[level]->tail()->getNelms() == 1 )
+            {
+                snprintf(idx_, sizeof(idx_), "%s", pathStack_[level]->tail()->getName());
+            }
+            else
+            {
+                snprintf(idx_, sizeof(idx_), "%s[%d]", pathStack_[level]->tail()->getName(), i);
+            }
+
+            if ( level == 0 )
+            {
+                // explore already expands the last level of the prefix
+                if ( t != i )
+                {
+                    snprintf(idx_, sizeof(idx_), "%s[%d-%d]", pathStack_[level]->tail()->getName(), i, t);
+                }
+                workingPrefix_->findByName( idx_ )->explore( this );
+                return;
+            }
+
+            yamlWrite("%*s%s:\n", yamlIndent(), "", idx_ );
+            workingPrefix_ = workingPrefix_->findByName( idx_ );
+            pushYamlIndent();
+                processStack( level - 1 );
+            popYamlIndent();
+            workingPrefix_->up();
+        }
+    }
+}
+
+void YCPSWASYNGenerateDB::walk(Path p)
+{
+    YCPSWASYNPhaseTimer walkTimer(drv_->phases_[PHASE_WALK]);
+
+    workingPrefix_ = p->clone();
+
+    do
+    {
+        pathStack_.push_back( workingPrefix_ );
+        workingPrefix_ = workingPrefix_->clone();
+        workingPrefix_->up();
+    }
+    while ( ! workingPrefix_->empty() );
+
+    processStack( pathStack_.size() - 1 );
+
+    walkTimer.setCount(leaves_.size());
+    walkTimer.stop();
+
+    {
+        YCPSWASYNPhaseTimer discoveryTimer(drv_->phases_[PHASE_DISCOVERY]);
+        discoveryTimer.setCount(leaves_.size());
+        discover();
+    }
+}
+
+void YCPSWASYNGenerateDB::createRecords()
+{
+    // Create the records in the walk order, so the record names and parameter
+    // indexes don't depend on the number of discovery threads
+    for (std::size_t i = 0; i < leaves_.size(); ++i)
+    {
+        int  type = drv_->CreateRecord( leaves_[i].p, leaves_[i].ifs );
+        char buf[64];
+
+        enum registerInterfaceTypeList ifType( static_cast<enum registerInterfaceTypeList>(type & 0xff) );
+        enum regTypeList               rgType( static_cast<enum regTypeList>         ((type>>8) & 0xff) );
+        snprintf(buf, sizeof(buf), " \"%s,%s\"", regInterfaceTypeNames[ifType], regTypeNames[rgType]);
+        yaml_[leaves_[i].segment] = buf;
+    }
+
+    leaves_.clear();
+}
+
+YCPSWKeysNotFound::YCPSWKeysNotFound(const std::string &fileName)
+    :
+    fileName_(fileName)
+{
+}
+
+void YCPSWKeysNotFound::insert(const std::string &element)
+{
+    list_.insert(element);
+}
+
+void YCPSWKeysNotFound::dump()
+{
+    YCPSWASYNRAIIFile f (YCPSWASYNRAIIFile(fileName_, "w"));
+
+    if (f.f())
+    {
+        for (std::set<std::string>::iterator it = list_.begin() ; it != list_.end() ; ++it )
+            f.write("%s\n", (*it).c_str());
+    }
+}
+
+// Remove '[a-b]' of the name when leaf are arrays
+std::string getNameWithoutLeafIndexes(const Path& p)
+{
+    std::string s(p->toString());
+    if (*s.rbegin() == ']')
+        s.erase(s.find_last_of('['));
+
+    return s;
+}
+
+// Escape the tabs and line breaks of a field of the auto-generation cache file
+std::string escapeCacheField(const std::string& field)
+{
+    std::string s;
+
+    for (std::size_t i = 0; i < field.size(); ++i)
+    {
+        switch (field[i])
+        {
+            case '\\': s += "\\\\"; break;
+            case '\t': s += "\\t";  break;
+            case '\n': s += "\\n";  break;
+            case '\r': s += "\\r";  break;
+            default:   s += field[i];
+        }
+    }
+
+    return s;
+}
+
+std::string unescapeCacheField(const std::string& field)
+{
+    std::string s;
+
+    for (std::size_t i = 0; i < field.size(); ++i)
+    {
+        if ( ( field[i] != '\\' ) || ( i + 1 == field.size() ) )
+        {
+            s += field[i];
+            continue;
+        }
+
+        switch (field[++i])
+        {
+            case 't': s += '\t'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            default:  s += field[i];
+        }
+    }
+
+    return s;
+}
+
+//////////////////////////////////////////////
+// - Methods overridden from asynPortDriver //
+//////////////////////////////////////////////
+
+/////////////////////////////////
+// Asynchronous device support //
+/////////////////////////////////
+// Records of scalar registers, and waveform records reading array registers, can use these
+// device types instead of the standard asyn ones, on ports with asynchronous workers. The
+// access is queued on the workers and the record stays active (PACT set) until it is
+// completed, so a failed access sets the alarm of the record itself, and the scan thread
+// goes on with the next records in the meantime.
+// The links have the syntax of the standard asyn device support:
+//   @asyn(PORT,ADDR)PARAM, or @asynMask(PORT,ADDR,MASK)PARAM for the digital interface.
+// I/O Intr scanning is not supported; those records use the standard asyn device support.
+// Arrays are read in chunks of YCPSWASYNSetArrayChunkSize elements, each one queued on its
+// own, so the other requests to the device are served between chunks.
+
+struct YCPSWASYNDset
+{
+    long        number;
+    DEVSUPFUN   report;
+    DEVSUPFUN   init;
+    DEVSUPFUN   init_record;
+    DEVSUPFUN   get_ioint_info;
+    DEVSUPFUN   io;
+    DEVSUPFUN   special_linconv;
+};
+
+// Split the link of a record into its port, address, mask (digital interface only) and parameter
+static bool parseRecordLink(const DBLINK& l, bool digital, std::string& port, int& addr, epicsUInt32& mask, std::string& param)
+{
+    const char  *prefix = digital ? "asynMask(" : "asyn(";
+    std::string s, args, arg;
+    std::size_t start, end;
+
+    if ( ( l.type != INST_IO ) || ( ! l.value.instio.string ) )
+        return false;
+
+    s     = l.value.instio.string;
+    start = s.find_first_not_of(" \t");
+    end   = s.find(')');
+
+    if ( ( start == std::string::npos ) || ( end == std::string::npos ) || s.compare(start, strlen(prefix), prefix) )
+        return false;
+
+    args  = s.substr(start + strlen(prefix), end - start - strlen(prefix));
+    param = s.substr(end + 1);
+    param.erase(0, param.find_first_not_of(" \t"));
+    param.erase(param.find_last_not_of(" \t") + 1);
+
+    std::istringstream argStream(args);
+    std::vector<std::string> fields;
+
+    while (std::getline(argStream, arg, ','))
+    {
+        arg.erase(0, arg.find_first_not_of(" \t"));
+        arg.erase(arg.find_last_not_of(" \t") + 1);
+        fields.push_back(arg);
     }
 
-    callParamCallbacks();
-    unlock();
+    if ( ( fields.size() < ( digital ? 3U : 2U ) ) || fields[0].empty() || param.empty() )
+        return false;
 
-    return (status==0) ? asynSuccess : asynError;
+    port = fields[0];
+    addr = strtol(fields[1].c_str(), NULL, 0);
+
+    if (digital)
+        mask = strtoul(fields[2].c_str(), NULL, 0);
+
+    return true;
 }
 
-asynStatus YCPSWASYN::writeUInt32Digital(asynUser *pasynUser, epicsUInt32 value, epicsUInt32 mask)
+// Split the link of a record, and find its port. Returns NULL if the link is not valid, or
+// the port is not a YCPSWASYN one.
+static YCPSWASYN *findRecordPort(dbCommon *prec, const DBLINK& l, bool digital, std::string& port, int& addr, epicsUInt32& mask, std::string& param)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    const char *name;
-    epicsUInt32 val;
+    YCPSWASYN *drv = NULL;
 
-    this->getAddress(pasynUser, &addr);
+    if (!parseRecordLink(l, digital, port, addr, mask, param))
+        fprintf(stderr, "%s: Invalid link. It must be @%s(PORT,ADDR%s)PARAM\n", prec->name, digital ? "asynMask" : "asyn", digital ? ",MASK" : "");
+    else if ( ! ( drv = dynamic_cast<YCPSWASYN*>( static_cast<asynPortDriver*>( findAsynPortDriver(port.c_str()) ) ) ) )
+        fprintf(stderr, "%s: %s is not a YCPSWASYN port\n", prec->name, port.c_str());
 
-    static const char *functionName = "writeUInt32Digital";
+    return drv;
+}
 
-    this->getAddress(pasynUser, &addr);
+// Attach a record to its register. Records which can't be attached are left active, so they are never processed.
+static long initRecord(dbCommon *prec, const DBLINK& l, int type)
+{
+    YCPSWASYNRecordRequest  *req = new YCPSWASYNRecordRequest;
+    YCPSWASYN               *drv;
+    bool                    digital = ( ( type == JOB_READ_DIGITAL ) || ( type == JOB_WRITE_DIGITAL ) );
+    std::string             port, param;
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    req->rec  = prec;
+    req->type = type;
+
+    if ( ( drv = findRecordPort(prec, l, digital, port, req->addr, req->mask, param) ) )
     {
-        try
-        {
-            if (addr == DEV_REG_RW)
-            {
-                val &= ~mask;
-                val |= value;
-                rw[function]->setVal((uint32_t*)&val, 1);
-            }
-            else if(addr == DEV_CMD)
-            {
-                cmd[function]->execute();
-            }
-            else
-                status = asynPortDriver::writeUInt32Digital(pasynUser, value, mask);
-        }
-        catch (CPSWError &e)
+        if (drv->initRecordRequest(req, param.c_str()))
         {
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            prec->dpvt = req;
+            return 0;
         }
-    }
-    else
-        status = asynPortDriver::writeUInt32Digital(pasynUser, value, mask);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s parameter %s set to %d\n", \
-                    driverName_, functionName, function, this->portName, name, value);
-    }
-    else
-    {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR setting parameter %s to %d (status = %d)\n", \
-                    driverName_, functionName, function, this->portName, name, value, status);
+        fprintf(stderr, "%s: Parameter %s is not a register of the right type on list %d of port %s, or the port has no asynchronous workers\n",
+            prec->name, param.c_str(), req->addr, port.c_str());
     }
 
-    callParamCallbacks(addr);
-    unlock();
-
-    return (status==0) ? asynSuccess : asynError;
+    delete req;
+    prec->pact = 1;
+    return ( type >= JOB_WRITE_INT32 ) ? S_dev_badOutType : S_dev_badInpType;
 }
 
-asynStatus YCPSWASYN::readUInt32Digital(asynUser *pasynUser, epicsUInt32 *value, epicsUInt32 mask)
+// Start the access of a record, or finish it when the record is processed again by the worker.
+// Returns false while the access is in flight. A failed access sets an INVALID alarm: COMM if
+// the device is not reachable, READ or WRITE otherwise.
+static bool processRecord(dbCommon *prec)
 {
-    int addr;
-    int function = pasynUser->reason;
-    int status=0;
-    uint32_t u32;
-    const char *name;
-
-    this->getAddress(pasynUser, &addr);
-
-    static const char *functionName = "readUInt32Digital";
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
 
-    lock();
-    if (!getParamName(addr, function, &name))
+    if (!prec->pact)
     {
-        try
-        {
-            if (addr == DEV_REG_RO)
-            {
-                ro[function]->getVal(&u32, 1);
-                u32 &= mask;
-                *value = (epicsInt32)u32;
-                status = setUIntDigitalParam(addr, function, (epicsUInt32)u32, mask);
-            }
-            else if (addr == DEV_REG_RW)
-            {
-                rw[function]->getVal(&u32, 1);
-                u32 &= mask;
-                *value = (epicsInt32)u32;
-                status = setUIntDigitalParam(addr, function, (epicsUInt32)u32, mask);
-            }
-            else if (addr == DEV_CMD)
-            {
-                u32 = 0;
-                *value = (epicsInt32)u32;
-                status = setUIntDigitalParam(addr, function, (epicsUInt32)u32, mask);
-            }
-            else if (addr == DEV_CONFIG)
-            {
-                status = getUIntDigitalParam(addr, function, value, mask);
-            }
+        req->status = 0;
+        req->down   = false;
 
-            else
-                status = asynPortDriver::readUInt32Digital(pasynUser, value, mask);
-        }
-        catch (CPSWError &e)
+        if (req->drv->queueRecordRequest(req))
         {
-            status = -1;
-            asynPrint(pasynUser, ASYN_TRACE_ERROR, "CPSW Error (during %s, parameter: %s): %s\n", functionName, name, e.getInfo().c_str());
+            prec->pact = 1;
+            return false;
         }
     }
-    else
-        status = asynPortDriver::readUInt32Digital(pasynUser, value, mask);
 
-    if (status == 0)
-    {
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s read %d from parameter %s\n", \
-                    driverName_, functionName, function, this->portName, *value, name);
-    }
-    else
+    if (req->status)
+        recGblSetSevr(prec, req->down ? COMM_ALARM : ( ( req->type >= JOB_WRITE_INT32 ) ? WRITE_ALARM : READ_ALARM ), INVALID_ALARM);
+
+    return true;
+}
+
+// Shift of the first bit of a mask, for the multi-bit binary records
+static epicsUInt16 maskShift(epicsUInt32 mask)
+{
+    epicsUInt16 shift = 0;
+
+    while ( mask && ! ( mask & 1 ) )
     {
-        asynPrint(pasynUser, ASYN_TRACE_ERROR, \
-                    "%s:%s(%d), port %s ERROR reading parameter %s (status = %d)\n", \
-                            driverName_, functionName, function, this->portName, name, status);
+        mask >>= 1;
+        ++shift;
     }
 
-    callParamCallbacks(addr);
-    unlock();
+    return shift;
+}
 
-    return (status==0) ? asynSuccess : asynError;
+static long initLongin(longinRecord *prec)
+{
+    return initRecord((dbCommon*)prec, prec->inp, JOB_READ_INT32);
 }
 
-asynStatus YCPSWASYN::getBounds(asynUser *pasynUser, epicsInt32 *low, epicsInt32 *high)
+static long readLongin(longinRecord *prec)
 {
-    int addr;
-    int status = 0;
-    int function = pasynUser->reason;
-    this->getAddress(pasynUser, &addr);
-    const char *name;
-    static const char *functionName = "getBounds";
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
 
-    if (!getParamName(addr, function, &name))
-        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER, \
-                    "%s:%s(%d), port %s getRegister %s\n", \
-                    driverName_, functionName, function, this->portName, name);
+    if ( ( ! processRecord((dbCommon*)prec) ) || req->status )
+        return req->status;
 
-    status = asynPortDriver::getBounds(pasynUser, low, high);
+    prec->val = (epicsInt32)req->u32;
+    prec->udf = 0;
+    return 0;
+}
 
-    return (status==0) ? asynSuccess : asynError;
+static long initLongout(longoutRecord *prec)
+{
+    long                   status = initRecord((dbCommon*)prec, prec->out, JOB_WRITE_INT32);
+    YCPSWASYNRecordRequest *req   = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if ( ( status == 0 ) && req->drv->getRecordValue(req) )
+    {
+        prec->val = (epicsInt32)req->u32;
+        prec->udf = 0;
+    }
 
+    return status;
 }
 
+static long writeLongout(longoutRecord *prec)
+{
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
 
-void YCPSWASYN::report(FILE *fp, int details)
+    if (!prec->pact)
+        req->u32 = (epicsUInt32)prec->val;
+
+    processRecord((dbCommon*)prec);
+    return req->status;
+}
+
+static long initAi(aiRecord *prec)
 {
-    fprintf(fp, "  Port: %s\n", this->portName);
-    asynPortDriver::report(fp, details);
+    return initRecord((dbCommon*)prec, prec->inp, JOB_READ_FLOAT64);
 }
 
-YCPSWASYNRAIIFile::YCPSWASYNRAIIFile(const std::string &name, const char *mode)
-    :
-    name_(name)
+// The value is not converted
+static long readAi(aiRecord *prec)
 {
-    if ( ! (f_ = fopen( name.c_str(), mode )) )
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if ( ( ! processRecord((dbCommon*)prec) ) || req->status )
+        return req->status;
+
+    prec->val = req->f64;
+    prec->udf = 0;
+    return 2;
+}
+
+static long initAo(aoRecord *prec)
+{
+    long                   status = initRecord((dbCommon*)prec, prec->out, JOB_WRITE_FLOAT64);
+    YCPSWASYNRecordRequest *req   = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if ( ( status == 0 ) && req->drv->getRecordValue(req) )
     {
-        printf("ERROR: Unable to open file: %s\n", name.c_str());
+        prec->val = req->f64;
+        prec->udf = 0;
     }
+
+    // The value is not converted
+    return ( status == 0 ) ? 2 : status;
 }
 
-void YCPSWASYNRAIIFile::write(const char * format, ...)
+static long writeAo(aoRecord *prec)
 {
-    if (f_ != NULL)
-        fprintf(f_, format);
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if (!prec->pact)
+        req->f64 = prec->oval;
+
+    processRecord((dbCommon*)prec);
+    return req->status;
 }
 
-YCPSWASYNRAIIFile::~YCPSWASYNRAIIFile()
+static long initBi(biRecord *prec)
 {
-    if (f_ != NULL)
-        fclose( f_ );
-}
+    long status = initRecord((dbCommon*)prec, prec->inp, JOB_READ_DIGITAL);
 
-YCPSWASYNGenerateDB::YCPSWASYNGenerateDB(const std::string &pre, YCPSWASYN *drv)
-    :
-    drv_   ( drv ),
-    indent_( 0   ),
-    textFile( YCPSWASYNRAIIFile( pre + REG_DUMP_TEXT_FILE_NAME, "w" ) ),
-    yamlFile( YCPSWASYNRAIIFile( pre + REG_DUMP_YAML_FILE_NAME, "w" ) )
+    if (status == 0)
+        prec->mask = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt)->mask;
+
+    return status;
+}
 
+static long readBi(biRecord *prec)
 {
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if ( ( ! processRecord((dbCommon*)prec) ) || req->status )
+        return req->status;
+
+    prec->rval = req->u32;
+    return 0;
 }
 
-bool YCPSWASYNGenerateDB::visitPre(ConstPath p)
+static long initBo(boRecord *prec)
 {
-    std::string rep = p->toString();
-    const char *lst = strrchr( rep.c_str(), '/' );
-    int         type;
+    long                   status = initRecord((dbCommon*)prec, prec->out, JOB_WRITE_DIGITAL);
+    YCPSWASYNRecordRequest *req   = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
 
-    lst = lst ? lst + 1 : rep.c_str();
-    yamlFile.write("%*s%s:", yamlIndent(), "", lst);
-    if ( ! p->tail()->isHub() )
+    if (status != 0)
+        return status;
+
+    prec->mask = req->mask;
+
+    // The raw value is converted
+    if (req->drv->getRecordValue(req))
     {
-        type = drv_->CreateRecord( p->clone() );
-        enum registerInterfaceTypeList ifType( static_cast<enum registerInterfaceTypeList>(type & 0xff) );
-        enum regTypeList               rgType( static_cast<enum regTypeList>         ((type>>8) & 0xff) );
-        yamlFile.write(" \"%s,%s\"", regInterfaceTypeNames[ifType], regTypeNames[rgType]);
-        textFile.write("%s\n", p->toString().c_str());
+        prec->rval = req->u32;
+        return 0;
     }
-    yamlFile.write("\n");
-    pushYamlIndent();
-    return true;
+
+    return 2;
 }
 
-void YCPSWASYNGenerateDB::visitPost(ConstPath p)
+static long writeBo(boRecord *prec)
 {
-    popYamlIndent();
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if (!prec->pact)
+        req->u32 = prec->rval;
+
+    processRecord((dbCommon*)prec);
+    return req->status;
 }
 
-void YCPSWASYNGenerateDB::processStack(unsigned level)
+static long initMbbi(mbbiRecord *prec)
 {
-    unsigned i, t;
+    long status = initRecord((dbCommon*)prec, prec->inp, JOB_READ_DIGITAL);
 
-    if  ( pathStack_[level]->empty() )
+    if (status == 0)
     {
-        // Process empty paths, (i.e. paths starting at root)
-        pathStack_[level]->explore( this );
+        prec->mask = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt)->mask;
+        prec->shft = maskShift(prec->mask);
     }
-    else
-    {
-        for ( i = pathStack_[level]->getTailFrom(); i <= (t = pathStack_[level]->getTailTo()); i++ )
-        {
-            if ( pathStack_[level]->tail()->getNelms() == 1 )
-            {
-                snprintf(idx_, sizeof(idx_), "%s", pathStack_[level]->tail()->getName());
-            }
-            else
-            {
-                snprintf(idx_, sizeof(idx_), "%s[%d]", pathStack_[level]->tail()->getName(), i);
-            }
 
-            if ( level == 0 )
-            {
-                // explore already expands the last level of the prefix
-                if ( t != i )
-                {
-                    snprintf(idx_, sizeof(idx_), "%s[%d-%d]", pathStack_[level]->tail()->getName(), i, t);
-                }
-                workingPrefix_->findByName( idx_ )->explore( this );
-                return;
-            }
+    return status;
+}
 
-            yamlFile.write("%*s%s:\n", yamlIndent(), "", idx_ );
-            workingPrefix_ = workingPrefix_->findByName( idx_ );
-            pushYamlIndent();
-                processStack( level - 1 );
-            popYamlIndent();
-            workingPrefix_->up();
-        }
-    }
+static long readMbbi(mbbiRecord *prec)
+{
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if ( ( ! processRecord((dbCommon*)prec) ) || req->status )
+        return req->status;
+
+    prec->rval = req->u32;
+    return 0;
 }
 
-void YCPSWASYNGenerateDB::genereate(Path p)
+static long initMbbo(mbboRecord *prec)
 {
-    workingPrefix_ = p->clone();
+    long                   status = initRecord((dbCommon*)prec, prec->out, JOB_WRITE_DIGITAL);
+    YCPSWASYNRecordRequest *req   = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
 
-    do
+    if (status != 0)
+        return status;
+
+    prec->mask = req->mask;
+    prec->shft = maskShift(req->mask);
+
+    // The raw value is converted
+    if (req->drv->getRecordValue(req))
     {
-        pathStack_.push_back( workingPrefix_ );
-        workingPrefix_ = workingPrefix_->clone();
-        workingPrefix_->up();
+        prec->rval = req->u32;
+        return 0;
     }
-    while ( ! workingPrefix_->empty() );
 
-    processStack( pathStack_.size() - 1 );
+    return 2;
 }
 
-YCPSWKeysNotFound::YCPSWKeysNotFound(const std::string &fileName)
-    :
-    fileName_(fileName)
+static long writeMbbo(mbboRecord *prec)
 {
+    YCPSWASYNRecordRequest *req = static_cast<YCPSWASYNRecordRequest*>(prec->dpvt);
+
+    if (!prec->pact)
+        req->u32 = prec->rval;
+
+    processRecord((dbCommon*)prec);
+    return req->status;
 }
 
-void YCPSWKeysNotFound::insert(const std::string &element)
-{
-    list_.insert(element);
+// Attach a waveform record to its array register. FTVL sets the type of the elements read.
+static long initWaveform(waveformRecord *prec)
+{
+    YCPSWASYNArrayRequest *req = new YCPSWASYNArrayRequest;
+    YCPSWASYN             *drv;
+    epicsUInt32           mask;
+    std::string           port, param;
+
+    req->rec  = (dbCommon*)prec;
+    req->ftvl = prec->ftvl;
+    req->nelm = prec->nelm;
+
+    switch (prec->ftvl)
+    {
+        case menuFtypeCHAR:
+        case menuFtypeUCHAR:
+            req->elementSize = sizeof(epicsInt8);
+            break;
+        case menuFtypeSHORT:
+        case menuFtypeUSHORT:
+            req->elementSize = sizeof(epicsInt16);
+            break;
+        case menuFtypeLONG:
+        case menuFtypeULONG:
+            req->elementSize = sizeof(epicsInt32);
+            break;
+        case menuFtypeDOUBLE:
+            req->elementSize = sizeof(epicsFloat64);
+            break;
+    }
+
+    if (!req->elementSize)
+    {
+        fprintf(stderr, "%s: FTVL must be CHAR, UCHAR, SHORT, USHORT, LONG, ULONG or DOUBLE\n", prec->name);
+    }
+    else if ( ( drv = findRecordPort(req->rec, prec->inp, false, port, req->addr, mask, param) ) )
+    {
+        if (drv->initArrayRequest(req, param.c_str()))
+        {
+            prec->dpvt = req;
+            return 0;
+        }
+
+        fprintf(stderr, "%s: Parameter %s is not an array register on list %d of port %s (floating point registers need FTVL DOUBLE), or the port has no asynchronous workers\n",
+            prec->name, param.c_str(), req->addr, port.c_str());
+    }
+
+    delete req;
+    prec->pact = 1;
+    return S_dev_badInpType;
 }
 
-void YCPSWKeysNotFound::dump()
+// The elements are copied from the request buffer once all the chunks are read. A change of the
+// array during the transfer sets a MINOR READ alarm.
+static long readWaveform(waveformRecord *prec)
 {
-    YCPSWASYNRAIIFile f (YCPSWASYNRAIIFile(fileName_, "w"));
+    YCPSWASYNArrayRequest *req = static_cast<YCPSWASYNArrayRequest*>(prec->dpvt);
 
-    if (f.f())
+    if ( ( ! prec->pact ) && req->drv->queueArrayRequest(req) )
     {
-        for (std::set<std::string>::iterator it = list_.begin() ; it != list_.end() ; ++it )
-            f.write("%s\n", (*it).c_str());
+        prec->pact = 1;
+        return 0;
     }
-}
 
-// Remove '[a-b]' of the name when leaf are arrays
-std::string getNameWithoutLeafIndexes(const Path& p)
-{
-    std::string s(p->toString());
-    if (*s.rbegin() == ']')
-        s.erase(s.find_last_of('['));
+    if (req->status)
+    {
+        recGblSetSevr(prec, req->down ? COMM_ALARM : READ_ALARM, INVALID_ALARM);
+        return req->status;
+    }
 
-    return s;
+    if (req->got)
+        memcpy(prec->bptr, &req->buffer[0], req->got * req->elementSize);
+
+    prec->nord = req->got;
+
+    if (req->changed)
+        recGblSetSevr(prec, READ_ALARM, MINOR_ALARM);
+
+    return 0;
 }
 
-//////////////////////////////////////////////
-// - Methods overridden from asynPortDriver //
-//////////////////////////////////////////////
+static YCPSWASYNDset devYCPSWASYNLonginInt32        = { 5, NULL, NULL, (DEVSUPFUN)initLongin,  NULL, (DEVSUPFUN)readLongin,  NULL };
+static YCPSWASYNDset devYCPSWASYNLongoutInt32       = { 5, NULL, NULL, (DEVSUPFUN)initLongout, NULL, (DEVSUPFUN)writeLongout, NULL };
+static YCPSWASYNDset devYCPSWASYNAiFloat64          = { 6, NULL, NULL, (DEVSUPFUN)initAi,      NULL, (DEVSUPFUN)readAi,      NULL };
+static YCPSWASYNDset devYCPSWASYNAoFloat64          = { 6, NULL, NULL, (DEVSUPFUN)initAo,      NULL, (DEVSUPFUN)writeAo,     NULL };
+static YCPSWASYNDset devYCPSWASYNBiUInt32Digital    = { 5, NULL, NULL, (DEVSUPFUN)initBi,      NULL, (DEVSUPFUN)readBi,      NULL };
+static YCPSWASYNDset devYCPSWASYNBoUInt32Digital    = { 5, NULL, NULL, (DEVSUPFUN)initBo,      NULL, (DEVSUPFUN)writeBo,     NULL };
+static YCPSWASYNDset devYCPSWASYNMbbiUInt32Digital  = { 5, NULL, NULL, (DEVSUPFUN)initMbbi,    NULL, (DEVSUPFUN)readMbbi,    NULL };
+static YCPSWASYNDset devYCPSWASYNMbboUInt32Digital  = { 5, NULL, NULL, (DEVSUPFUN)initMbbo,    NULL, (DEVSUPFUN)writeMbbo,   NULL };
+static YCPSWASYNDset devYCPSWASYNWaveformArrayIn    = { 5, NULL, NULL, (DEVSUPFUN)initWaveform, NULL, (DEVSUPFUN)readWaveform, NULL };
+
+extern "C" {
+    epicsExportAddress(dset, devYCPSWASYNLonginInt32);
+    epicsExportAddress(dset, devYCPSWASYNLongoutInt32);
+    epicsExportAddress(dset, devYCPSWASYNAiFloat64);
+    epicsExportAddress(dset, devYCPSWASYNAoFloat64);
+    epicsExportAddress(dset, devYCPSWASYNBiUInt32Digital);
+    epicsExportAddress(dset, devYCPSWASYNBoUInt32Digital);
+    epicsExportAddress(dset, devYCPSWASYNMbbiUInt32Digital);
+    epicsExportAddress(dset, devYCPSWASYNMbboUInt32Digital);
+    epicsExportAddress(dset, devYCPSWASYNWaveformArrayIn);
+}
 
 ////////////////////////////////////
 // Driver configuration functions //
@@ -2686,6 +7016,427 @@ static void debugFilePathCallFunc(const iocshArgBuf *args)
     YCPSWASYNSetDebugFilePath(args[0].sval);
 }
 
+// YCPSWASYNSetShards
+extern "C" int YCPSWASYNSetShards(int nShards, int keyMode)
+{
+    if ( ( nShards < 1 ) || ( nShards > SHARD_MAX ) )
+    {
+        fprintf( stderr, "Error: The number of shards must be between 1 and %d\n", SHARD_MAX );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::shardCount );
+        return asynError;
+    }
+
+    if ( ( keyMode < 0 ) || ( keyMode >= SHARD_KEY_SIZE ) )
+    {
+        fprintf( stderr, "Error: Invalid shard key mode %d (0: subtree, 1: device)\n", keyMode );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::shardKeyMode );
+        return asynError;
+    }
+
+    YCPSWASYN::shardCount   = nShards;
+    YCPSWASYN::shardKeyMode = keyMode;
+
+    return asynSuccess;
+}
+
+static const iocshArg shardsArg0 = { "nShards", iocshArgInt };
+static const iocshArg shardsArg1 = { "keyMode", iocshArgInt };
+
+static const iocshArg * const shardsArgs[] =
+{
+    &shardsArg0,
+    &shardsArg1
+};
+
+static const iocshFuncDef shardsFuncDef = { "YCPSWASYNSetShards", 2, shardsArgs };
+
+static void shardsCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetShards(args[0].ival, args[1].ival);
+}
+
+// YCPSWASYNSetAsyncWorkers
+extern "C" int YCPSWASYNSetAsyncWorkers(int nWorkers, double pollPeriod)
+{
+    if ( nWorkers < 0 )
+    {
+        fprintf( stderr, "Error: The number of workers can not be negative\n" );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::asyncWorkers );
+        return asynError;
+    }
+
+    if ( pollPeriod < 0 )
+    {
+        fprintf( stderr, "Error: The poll period can not be negative\n" );
+        fprintf( stderr, "Keeping default value %f\n", YCPSWASYN::asyncPollPeriod );
+        return asynError;
+    }
+
+    YCPSWASYN::asyncWorkers    = nWorkers;
+    YCPSWASYN::asyncPollPeriod = pollPeriod;
+    return asynSuccess;
+}
+
+static const iocshArg asyncWorkersArg0 = { "nWorkers",   iocshArgInt };
+static const iocshArg asyncWorkersArg1 = { "pollPeriod", iocshArgDouble };
+
+static const iocshArg * const asyncWorkersArgs[] =
+{
+    &asyncWorkersArg0,
+    &asyncWorkersArg1
+};
+
+static const iocshFuncDef asyncWorkersFuncDef = { "YCPSWASYNSetAsyncWorkers", 2, asyncWorkersArgs };
+
+static void asyncWorkersCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetAsyncWorkers(args[0].ival, args[1].dval);
+}
+
+// YCPSWASYNSetArrayChunkSize
+extern "C" int YCPSWASYNSetArrayChunkSize(int nElements)
+{
+    if ( nElements < 0 )
+    {
+        fprintf( stderr, "Error: The array chunk size can not be negative\n" );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::arrayChunkSize );
+        return asynError;
+    }
+
+    YCPSWASYN::arrayChunkSize = nElements;
+    return asynSuccess;
+}
+
+static const iocshArg arrayChunkSizeArg0 = { "nElements", iocshArgInt };
+
+static const iocshArg * const arrayChunkSizeArgs[] =
+{
+    &arrayChunkSizeArg0
+};
+
+static const iocshFuncDef arrayChunkSizeFuncDef = { "YCPSWASYNSetArrayChunkSize", 1, arrayChunkSizeArgs };
+
+static void arrayChunkSizeCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetArrayChunkSize(args[0].ival);
+}
+
+// YCPSWASYNSetPrefetch
+extern "C" int YCPSWASYNSetPrefetch(int nThreads)
+{
+    if ( nThreads < 0 )
+    {
+        fprintf( stderr, "Error: The number of prefetch threads can not be negative\n" );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::prefetchThreads );
+        return asynError;
+    }
+
+    YCPSWASYN::prefetchThreads = nThreads;
+    return asynSuccess;
+}
+
+static const iocshArg prefetchArg0 = { "nThreads", iocshArgInt };
+
+static const iocshArg * const prefetchArgs[] =
+{
+    &prefetchArg0
+};
+
+static const iocshFuncDef prefetchFuncDef = { "YCPSWASYNSetPrefetch", 1, prefetchArgs };
+
+static void prefetchCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetPrefetch(args[0].ival);
+}
+
+// YCPSWASYNSetBatchLoad
+// Only plain record templates are expanded into the batch database. Templates with include or
+// substitute directives, or records with undefined macros, are still loaded one at a time.
+extern "C" int YCPSWASYNSetBatchLoad(int enable)
+{
+    if ( ( enable != 0 ) && ( enable != 1 ) )
+    {
+        fprintf( stderr, "Error: Invalid value %d. It must be 0 (one load per record) or 1 (one load for all records)\n", enable );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::batchLoad );
+        return asynError;
+    }
+
+    YCPSWASYN::batchLoad = enable;
+    return asynSuccess;
+}
+
+static const iocshArg batchLoadArg0 = { "enable", iocshArgInt };
+
+static const iocshArg * const batchLoadArgs[] =
+{
+    &batchLoadArg0
+};
+
+static const iocshFuncDef batchLoadFuncDef = { "YCPSWASYNSetBatchLoad", 1, batchLoadArgs };
+
+static void batchLoadCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetBatchLoad(args[0].ival);
+}
+
+// YCPSWASYNSetLazyInterfaces
+extern "C" int YCPSWASYNSetLazyInterfaces(int enable)
+{
+    if ( ( enable != 0 ) && ( enable != 1 ) )
+    {
+        fprintf( stderr, "Error: Invalid value %d. It must be 0 (create at startup) or 1 (create on first access)\n", enable );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::lazyInterfaces );
+        return asynError;
+    }
+
+    YCPSWASYN::lazyInterfaces = enable;
+
+    // Only the registers loaded from the auto-generation cache are created on first use
+    if ( enable && YCPSWASYN::generationCachePath.empty() )
+        printf( "Warning: No auto-generation cache is set. Lazy interfaces have no effect unless YCPSWASYNSetGenerationCache is also called\n" );
+
+    return asynSuccess;
+}
+
+static const iocshArg lazyInterfacesArg0 = { "enable", iocshArgInt };
+
+static const iocshArg * const lazyInterfacesArgs[] =
+{
+    &lazyInterfacesArg0
+};
+
+static const iocshFuncDef lazyInterfacesFuncDef = { "YCPSWASYNSetLazyInterfaces", 1, lazyInterfacesArgs };
+
+static void lazyInterfacesCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetLazyInterfaces(args[0].ival);
+}
+
+// YCPSWASYNAddPathFilter
+extern "C" int YCPSWASYNAddPathFilter(const char* action, const char* pattern)
+{
+    if ( ( ! action ) || ( ! pattern ) )
+    {
+        fprintf( stderr, "Error: The filter action and pattern must be defined\n" );
+        return asynError;
+    }
+
+    return YCPSWASYN::addPathFilter(action, pattern) ? asynSuccess : asynError;
+}
+
+static const iocshArg addPathFilterArg0 = { "action",  iocshArgString };
+static const iocshArg addPathFilterArg1 = { "pattern", iocshArgString };
+
+static const iocshArg * const addPathFilterArgs[] =
+{
+    &addPathFilterArg0,
+    &addPathFilterArg1
+};
+
+static const iocshFuncDef addPathFilterFuncDef = { "YCPSWASYNAddPathFilter", 2, addPathFilterArgs };
+
+static void addPathFilterCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNAddPathFilter(args[0].sval, args[1].sval);
+}
+
+// YCPSWASYNLoadPathFilters
+extern "C" int YCPSWASYNLoadPathFilters(const char* fileName)
+{
+    std::ifstream filterFile;
+    std::string   line;
+    int           status = asynSuccess;
+
+    if ( ( ! fileName ) || ( fileName[0] == '\0' ) )
+    {
+        fprintf( stderr, "Error: Filter file name is empty\n" );
+        return asynError;
+    }
+
+    filterFile.open(fileName);
+    if ( ! filterFile.is_open() )
+    {
+        fprintf( stderr, "Error: Filter file \"%s\" not found\n", fileName );
+        return asynError;
+    }
+
+    // Each line has an action and a pattern. Lines starting with '#' are comments.
+    while (std::getline(filterFile, line))
+    {
+        std::istringstream iss(line);
+        std::string        action, pattern;
+
+        iss >> action >> std::ws;
+        std::getline(iss, pattern);
+        pattern.erase(pattern.find_last_not_of(" \t\r") + 1);
+
+        if ( action.empty() || ( action[0] == '#' ) )
+            continue;
+
+        if ( ! YCPSWASYN::addPathFilter(action, pattern) )
+        {
+            fprintf( stderr, "Error on filter file \"%s\": %s\n", fileName, line.c_str() );
+            status = asynError;
+        }
+    }
+
+    return status;
+}
+
+static const iocshArg loadPathFiltersArg0 = { "fileName", iocshArgString };
+
+static const iocshArg * const loadPathFiltersArgs[] =
+{
+    &loadPathFiltersArg0
+};
+
+static const iocshFuncDef loadPathFiltersFuncDef = { "YCPSWASYNLoadPathFilters", 1, loadPathFiltersArgs };
+
+static void loadPathFiltersCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNLoadPathFilters(args[0].sval);
+}
+
+// YCPSWASYNSetDeferredInit
+extern "C" int YCPSWASYNSetDeferredInit(int enable)
+{
+    if ( ( enable != 0 ) && ( enable != 1 ) )
+    {
+        fprintf( stderr, "Error: Invalid value %d. It must be 0 (initialize each port) or 1 (defer it to YCPSWASYNInitPorts)\n", enable );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::deferredInit );
+        return asynError;
+    }
+
+    YCPSWASYN::deferredInit = enable;
+    return asynSuccess;
+}
+
+static const iocshArg deferredInitArg0 = { "enable", iocshArgInt };
+
+static const iocshArg * const deferredInitArgs[] =
+{
+    &deferredInitArg0
+};
+
+static const iocshFuncDef deferredInitFuncDef = { "YCPSWASYNSetDeferredInit", 1, deferredInitArgs };
+
+static void deferredInitCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetDeferredInit(args[0].ival);
+}
+
+// YCPSWASYNInitPorts
+extern "C" int YCPSWASYNInitPorts(void)
+{
+    return ( YCPSWASYN::initDeferredPorts() == 0 ) ? asynSuccess : asynError;
+}
+
+static const iocshFuncDef initPortsFuncDef = { "YCPSWASYNInitPorts", 0, NULL };
+
+static void initPortsCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNInitPorts();
+}
+
+// YCPSWASYNSetDeviceTrip
+extern "C" int YCPSWASYNSetDeviceTrip(int nFailures, double probePeriod)
+{
+    if ( nFailures < 0 )
+    {
+        fprintf( stderr, "Error: The number of failures can not be negative\n" );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::deviceTripCount );
+        return asynError;
+    }
+
+    if ( probePeriod <= 0 )
+    {
+        fprintf( stderr, "Error: The probe period must be greater than 0\n" );
+        fprintf( stderr, "Keeping default value %f\n", YCPSWASYN::deviceProbePeriod );
+        return asynError;
+    }
+
+    YCPSWASYN::deviceTripCount   = nFailures;
+    YCPSWASYN::deviceProbePeriod = probePeriod;
+    return asynSuccess;
+}
+
+static const iocshArg deviceTripArg0 = { "nFailures",   iocshArgInt    };
+static const iocshArg deviceTripArg1 = { "probePeriod", iocshArgDouble };
+
+static const iocshArg * const deviceTripArgs[] =
+{
+    &deviceTripArg0,
+    &deviceTripArg1
+};
+
+static const iocshFuncDef deviceTripFuncDef = { "YCPSWASYNSetDeviceTrip", 2, deviceTripArgs };
+
+static void deviceTripCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetDeviceTrip(args[0].ival, args[1].dval);
+}
+
+// YCPSWASYNSetDiscoveryThreads
+extern "C" int YCPSWASYNSetDiscoveryThreads(int nThreads)
+{
+    if ( nThreads < 1 )
+    {
+        fprintf( stderr, "Error: The number of discovery threads must be at least 1\n" );
+        fprintf( stderr, "Keeping default value %d\n", YCPSWASYN::discoveryThreads );
+        return asynError;
+    }
+
+    YCPSWASYN::discoveryThreads = nThreads;
+    return asynSuccess;
+}
+
+static const iocshArg discoveryThreadsArg0 = { "nThreads", iocshArgInt };
+
+static const iocshArg * const discoveryThreadsArgs[] =
+{
+    &discoveryThreadsArg0
+};
+
+static const iocshFuncDef discoveryThreadsFuncDef = { "YCPSWASYNSetDiscoveryThreads", 1, discoveryThreadsArgs };
+
+static void discoveryThreadsCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetDiscoveryThreads(args[0].ival);
+}
+
+// YCPSWASYNSetGenerationCache
+extern "C" int YCPSWASYNSetGenerationCache(const char* cachePath)
+{
+    if ( ( ! cachePath ) || ( cachePath[0] == '\0' ) )
+    {
+        YCPSWASYN::generationCachePath.clear();
+        printf( "The auto-generation cache is disabled\n" );
+    }
+    else
+    {
+        YCPSWASYN::generationCachePath = cachePath;
+
+        if ( cachePath[ strlen( cachePath ) - 1 ] != '/' )
+            YCPSWASYN::generationCachePath += '/';
+    }
+
+    return asynSuccess;
+}
+
+static const iocshArg generationCacheArg0 = { "cachePath", iocshArgString };
+
+static const iocshArg * const generationCacheArgs[] =
+{
+    &generationCacheArg0
+};
+
+static const iocshFuncDef generationCacheFuncDef = { "YCPSWASYNSetGenerationCache", 1, generationCacheArgs };
+
+static void generationCacheCallFunc(const iocshArgBuf *args)
+{
+    YCPSWASYNSetGenerationCache(args[0].sval);
+}
+
 // iocshRegister
 void drvYCPSWASYNRegister(void)
 {
@@ -2694,6 +7445,21 @@ void drvYCPSWASYNRegister(void)
     iocshRegister( &nameMaxLenFuncDef,    nameMaxLenCallFunc    );
     iocshRegister( &mapFilePathFuncDef,   mapFilePathCallFunc   );
     iocshRegister( &debugFilePathFuncDef, debugFilePathCallFunc );
+    iocshRegister( &shardsFuncDef,        shardsCallFunc        );
+    iocshRegister( &asyncWorkersFuncDef,  asyncWorkersCallFunc  );
+    iocshRegister( &arrayChunkSizeFuncDef, arrayChunkSizeCallFunc );
+    iocshRegister( &prefetchFuncDef,      prefetchCallFunc      );
+    iocshRegister( &deviceTripFuncDef,    deviceTripCallFunc    );
+    iocshRegister( &discoveryThreadsFuncDef, discoveryThreadsCallFunc );
+    iocshRegister( &generationCacheFuncDef, generationCacheCallFunc );
+    iocshRegister( &batchLoadFuncDef,     batchLoadCallFunc     );
+    iocshRegister( &lazyInterfacesFuncDef, lazyInterfacesCallFunc );
+    iocshRegister( &addPathFilterFuncDef, addPathFilterCallFunc );
+    iocshRegister( &loadPathFiltersFuncDef, loadPathFiltersCallFunc );
+    iocshRegister( &deferredInitFuncDef,  deferredInitCallFunc  );
+    iocshRegister( &initPortsFuncDef,     initPortsCallFunc     );
+
+    initHookRegister( YCPSWASYN::startupInitHook );
 }
 
 extern "C" {
@@ -25,7 +25,21 @@
 #include <stdio.h>
 #include <string.h>
 #include <fstream>
+#include <vector>
+#include <deque>
+#include <set>
+#include <regex.h>
 #include <boost/array.hpp>
+#include <boost/unordered_map.hpp>
+#include <epicsMutex.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsAtomic.h>
+#include <macLib.h>
+#include <initHooks.h>
+#include <callback.h>
+#include <dbCommon.h>
 #include "asynPortDriver.h"
 
 #include <cpsw_api_builder.h>
@@ -60,6 +74,11 @@
 #define KEYS_NOT_FOUND_FILE_NAME    "keysNotFound.txt"
 #define MAP_TOP_FILE_NAME           "map_top"
 #define MAP_FILE_NAME               "map"
+#define HIERARCHY_DUMP_FILE_NAME    "hierarchy.yaml"
+#define GEN_CACHE_FILE_NAME         "genCache.txt"
+#define RECORDS_DB_FILE_NAME        "records.db"
+#define STARTUP_PROFILE_FILE_NAME   "startupProfile.json"
+#define GEN_CACHE_VERSION           "1"             // Incremented when the format of the generation cache file changes
 
 // These are the drvInfo strings that are used to identify the parameters.
 // They are used by asyn clients, including standard asyn device support
@@ -71,6 +90,15 @@
 #define saveConfigStatusString  "CONFIG_SAVE_STATUS"
 #define loadConfigRootString    "CONFIG_LOAD_ROOT"
 #define saveConfigRootString    "CONFIG_SAVE_ROOT"
+#define latencyResetString      "LATENCY_RESET"
+#define devicesDownString       "DEVICES_DOWN"
+#define deviceErrorsString      "DEVICE_ERRORS"
+
+// Device types of the asynchronous device support
+#define ASYNC_DTYP_INT32        "ycpswasynAsyncInt32"
+#define ASYNC_DTYP_DIGITAL      "ycpswasynAsyncUInt32Digital"
+#define ASYNC_DTYP_FLOAT64      "ycpswasynAsyncFloat64"
+#define ASYNC_DTYP_ARRAY_IN     "ycpswasynAsyncArrayIn"
 
 #define mapTopFileVar           "YCPSWASYN_MAP_TOP_FILE"
 #define mapFileVar              "YCPSWASYN_MAP_FILE"
@@ -149,6 +177,8 @@ enum regTypeList
     REG_ARRAY,      // Array registers
     REG_ARRAY_8,    // 8-bit array register
     REG_STRING,     // String register
+    REG_ARRAY_16,   // 9 to 16-bit array register
+    REG_ARRAY_INT8, // Up to 7-bit array register
     REG_STREAM,     // Stream register
     REG_SIZE
 };
@@ -160,6 +190,8 @@ char const *regTypeNames[] =
   "ARR",
   "AR8",
   "STR",
+  "A16",
+  "AI8",
   "STM"
 };
 
@@ -174,12 +206,12 @@ enum waveformTypeList
 // record template list (all interfaces but streams)
 const char *templateList[DEV_SIZE - 1][REG_SIZE-1] =
 {
-     // DEV_SINGLE,             // REG_ENUM             // REG_ARRAY                        // REG_ARRAY_8                  // REG_STRING
-    {"db/longin.template",      "db/mbbi.template",     "db/waveform_in.template",          "db/waveform_8_in.template",    "db/waveform_8_in.template"},   //DEV_REG_RO
-    {"db/longout.template",     "db/mbbo.template",     "db/waveform_out.template",         "db/waveform_8_out.template",   "db/waveform_8_out.template"},  //DEV_REG_RW
-    {"db/ai.template",          "",                     "db/waveform_in_float.template",    "",                             ""},                            //DEV_FLOAT_RO
-    {"db/ao.template",          "",                     "db/waveform_out_float.template",   "",                             ""},                            //DEV_FLOAT_RW
-    {"db/bo.template",          "",                     "",                                 "",                             ""},                            //DEV_CMD
+     // DEV_SINGLE,             // REG_ENUM             // REG_ARRAY                        // REG_ARRAY_8                  // REG_STRING                   // REG_ARRAY_16                     // REG_ARRAY_INT8
+    {"db/longin.template",      "db/mbbi.template",     "db/waveform_in.template",          "db/waveform_8_in.template",    "db/waveform_8_in.template",    "db/waveform_int16_in.template",    "db/waveform_int8_in.template"},    //DEV_REG_RO
+    {"db/longout.template",     "db/mbbo.template",     "db/waveform_out.template",         "db/waveform_8_out.template",   "db/waveform_8_out.template",   "db/waveform_int16_out.template",   "db/waveform_int8_out.template"},   //DEV_REG_RW
+    {"db/ai.template",          "",                     "db/waveform_in_float.template",    "",                             "",                             "",                                 ""},                                //DEV_FLOAT_RO
+    {"db/ao.template",          "",                     "db/waveform_out_float.template",   "",                             "",                             "",                                 ""},                                //DEV_FLOAT_RW
+    {"db/bo.template",          "",                     "",                                 "",                             "",                             "",                                 ""},                                //DEV_CMD
 };
 
 // Record template list (only for streams)
@@ -188,6 +220,17 @@ const char * templateListWaforms[WF_SIZE] =
     "db/waveform_stream32.template",    "db/waveform_stream16.template" //DEV_STM
 };
 
+// Ways of assigning auto-generated registers to shards (asyn ports with their own queue thread)
+enum shardKeyModeList
+{
+    SHARD_KEY_SUBTREE,  // By top level subtree below the root path
+    SHARD_KEY_DEVICE,   // By hash of the device name
+    SHARD_KEY_SIZE
+};
+
+#define SHARD_MAX           64                              // Max number of shards per YCPSWASYNConfig call
+#define SHARD_NAME_SUFFIX   "_S"                            // Shard port name: <port name>_S<shard number>
+
 #define PROCESS_CONFIG_MASK     0x03
 enum processConfigurationStates
 {
@@ -198,6 +241,71 @@ enum processConfigurationStates
     CONFIGF_STAT_SIZE
 };
 
+// Command execution status (<param>:STATUS)
+enum commandStatusList
+{
+    CMD_STAT_SUCCESS,   // Last execution finished successfully
+    CMD_STAT_ERROR      // Last execution failed
+};
+
+#define COMMAND_BUSY_SUFFIX     ":BUSY"         // Command running parameter name: <param name>:BUSY
+#define COMMAND_STATUS_SUFFIX   ":STATUS"       // Command status parameter name: <param name>:STATUS
+#define COMMAND_DURATION_SUFFIX ":DURATION"     // Command duration (seconds) parameter name: <param name>:DURATION
+#define COMMAND_EXECUTOR_SUFFIX "_CMD"          // Command executor thread name: <port name>_CMD
+
+// Latency statistics of the requests served on a lane
+struct YCPSWASYNLatencyStats
+{
+    long    count;          // Number of requests
+    double  sum;            // Sum of their latency (seconds)
+    double  max;            // Max latency (seconds)
+    int     countParam;     // Parameter indexes, on the DEV_CONFIG list
+    int     meanParam;
+    int     maxParam;
+};
+
+// CPSW interfaces attached to a register path
+struct YCPSWASYNInterfaces
+{
+    ScalVal_RO      ro;
+    ScalVal         rw;
+    DoubleVal_RO    fo;
+    DoubleVal       fw;
+    Command         cmd;
+    Stream          stm;
+};
+
+// Kind of register on a leaf, from the CPSW interfaces it supports
+enum leafKindList {LEAF_NONE, LEAF_RO, LEAF_RW, LEAF_FO, LEAF_FW, LEAF_CMD, LEAF_STM};
+
+// Kind of the registers of a field. It is found by probing the interfaces of the first
+// leaf of the field, which throws an exception for each interface it doesn't support.
+struct YCPSWASYNLeafClass
+{
+    int     kind;           // See leafKindList
+    int     exceptions;     // Exceptions thrown by the probe
+};
+
+// Filter on the paths of the auto-generated registers. Excluded subtrees are not
+// explored; with include filters, only the registers in an included subtree are created.
+struct YCPSWASYNPathFilter
+{
+    bool        include;    // Include (true) or exclude (false) the matching paths
+    std::string pattern;    // Glob pattern, or extended regular expression after the "re:" prefix
+    regex_t     *re;        // Compiled regular expression (NULL for glob patterns)
+};
+
+#define PATH_FILTER_REGEX_PREFIX    "re:"
+
+// Execution state of a command, and the parameters it is reported on
+struct YCPSWASYNCommandStatus
+{
+    bool    busy;           // The command is running
+    int     busyParam;      // Parameter indexes, on the DEV_CMD list
+    int     statusParam;
+    int     durationParam;
+};
+
 // Argument list passed to the stream handling thread
 typedef struct
 {
@@ -218,14 +326,754 @@ struct recordParams
     std::string recRbvName;
 };
 
+// Entry of the auto-generation cache file. Besides the records, the file has the
+// steps done between them, so they are replayed in the same order.
+struct YCPSWASYNCacheEntry
+{
+    char                type;       // 'S': select the shard of a register, 'G': create a field group,
+                                    // 'R': load a record, 'T': start a stream thread, 'K': key not found
+    Path                p;          // Register path
+    std::string         name;       // Key not found
+    int                 regType;    // Record (parameter list, template and parameter)
+    int                 element;
+    recordParams        rp;
+    std::string         dbParams;
+    YCPSWASYNInterfaces ifs;        // CPSW interface of the register
+};
+
 #define MAX_SIGNALS         ((int)DEV_SIZE)                 // Max number of parameter list (size of register type list)
-#define NUM_SCALVALS        5000                            // Max number of ScalVals
-#define NUM_DOUBLEVALS      100                             // Max number of DoubleVals
-#define NUM_CMD             500                             // Max number of commands
-#define NUM_PARAMS          (NUM_SCALVALS + NUM_CMD)        // Max number of parameters
+#define INTERFACE_MASK      (asynInt32Mask | asynDrvUserMask | asynInt8ArrayMask | asynInt16ArrayMask | asynInt32ArrayMask | asynOctetMask | \
+                             asynFloat64ArrayMask | asynUInt32DigitalMask | asynFloat64Mask)
+#define INTERRUPT_MASK      (asynInt8ArrayMask | asynInt16ArrayMask | asynInt32ArrayMask | asynInt32Mask | asynUInt32DigitalMask)
 #define STREAM_MAX_SIZE     200UL*1024ULL*1024ULL           // Size of the stream buffers
+#define ARRAY_OFFSET_SUFFIX ":OFS"                          // Array window offset parameter name: <param name>:OFS
+#define ARRAY_LENGTH_SUFFIX ":LEN"                          // Array window length parameter name: <param name>:LEN
+#define ARRAY_COMPARE_BLOCK_SIZE 64                         // Block size (bytes) used to find the changed elements of an array
+
+// CPSW word type used to transfer arrays of each asyn integer type
+template <typename V> struct YCPSWASYNNativeType;
+template <> struct YCPSWASYNNativeType<epicsInt8>  { typedef uint8_t  type; };
+template <> struct YCPSWASYNNativeType<epicsInt16> { typedef uint16_t type; };
+template <> struct YCPSWASYNNativeType<epicsInt32> { typedef uint32_t type; };
+
+// Request lanes. Writes, commands and configuration operations go on the high
+// priority lane, and are served ahead of the reads and array transfers on the
+// low priority lane.
+enum requestLaneList
+{
+    LANE_HIGH,
+    LANE_LOW,
+    LANE_SIZE
+};
+
+char const *laneNames[LANE_SIZE] =
+{
+    "HIGH",
+    "LOW"
+};
+
+#define LANE_YIELD_TIMEOUT      0.01            // Max time (seconds) a low priority request steps aside for a high priority one
+#define LATENCY_PREFIX          "LATENCY_"      // Lane latency parameter names: LATENCY_<lane><suffix>
+#define LATENCY_COUNT_SUFFIX    "_COUNT"        // Number of requests
+#define LATENCY_MEAN_SUFFIX     "_MEAN"         // Mean latency (seconds)
+#define LATENCY_MAX_SUFFIX      "_MAX"          // Max latency (seconds)
+
+// Phases of the start up of a port, timed by the startup profiler
+enum startupPhaseList
+{
+    PHASE_INIT,         // Root path lookup (YCPSWASYNInit)
+    PHASE_MAP_FILES,    // Substitution map loading
+    PHASE_CACHE,        // Auto-generation cache key, and creation of the cached interfaces
+    PHASE_WALK,         // Hierarchy walk
+    PHASE_DISCOVERY,    // CPSW interface creation
+    PHASE_NAMES,        // Record name generation
+    PHASE_RECORDS,      // Parameter and record creation (LoadRecord)
+    PHASE_DB_LOAD,      // Load of the auto-generated database
+    PHASE_DICTIONARY,   // Dictionary processing
+    PHASE_PREFETCH,     // Register prefetch
+    PHASE_IOC_INIT,     // iocInit, including the initial (PINI) processing of the records
+    PHASE_SIZE
+};
+
+char const *startupPhaseNames[PHASE_SIZE] =
+{
+    "init",
+    "mapFiles",
+    "cache",
+    "walk",
+    "discovery",
+    "names",
+    "records",
+    "dbLoad",
+    "dictionary",
+    "prefetch",
+    "iocInit"
+};
+
+// Time spent on a startup phase
+struct YCPSWASYNPhaseStats
+{
+    YCPSWASYNPhaseStats() : wall(0), cpu(0), count(0) {}
+
+    double          wall;       // Wall clock time (seconds)
+    double          cpu;        // CPU time of the thread doing the phase (seconds)
+    unsigned long   count;      // Number of times the phase was done, or items it processed
+};
+
+// Scope timed as part of a startup phase. Its wall and CPU time are added to the
+// phase when it ends (or stop() is called), and its count is increased by one, or
+// by the number of items set.
+class YCPSWASYNPhaseTimer
+{
+    private:
+        YCPSWASYNPhaseStats &stats_;
+        epicsTimeStamp      wallStart_;
+        double              cpuStart_;
+        unsigned long       count_;
+        bool                running_;
+
+    public:
+        YCPSWASYNPhaseTimer(YCPSWASYNPhaseStats& stats);
+        ~YCPSWASYNPhaseTimer();
+
+        void stop();
+
+        void setCount(unsigned long count)
+        {
+            count_ = count;
+        }
+
+        // CPU time used by the calling thread so far (seconds)
+        static double cpuSeconds();
+};
+
+// Error thrown, without a CPSW transaction, by requests to a device which is not reachable
+class YCPSWASYNDeviceDown : public CPSWError
+{
+    public:
+        YCPSWASYNDeviceDown(const std::string& name) : CPSWError("Device not reachable: " + name) {}
+};
+
+// Result of the transactions done while holding the lock of a device
+enum transactionResultList
+{
+    RESULT_SUCCESS,     // The transactions were done
+    RESULT_ERROR,       // A transaction failed, but not because the device is not reachable
+    RESULT_UNREACHABLE, // A transaction failed with an IO or timeout error
+    RESULT_NONE         // The transactions are not accounted (e.g. configuration load/save)
+};
+
+// Device (CPSW hub) where registers are located. CPSW transactions on
+// registers of the same device are serialized with its lock.
+//
+// The device also tracks its health: after tripThreshold consecutive
+// transactions failed with an IO or timeout error it is tripped, and requests
+// to it fail right away, until a probe read of one of its registers succeeds
+// again. A device without a register to probe lets one request through each
+// probe period instead, and is back when that request succeeds.
+struct YCPSWASYNDevice
+{
+    YCPSWASYNDevice() : highWaiting(0), tripThreshold(0), failures(0), tripped(0), trial(0), failedRequests(0), generation(0) {}
+
+    std::string name;
+    epicsMutex  lock;
+    int         highWaiting;    // Number of high priority requests waiting for the lock
+    epicsEvent  highDone;       // Signaled when a high priority request gets the lock
+    int         tripThreshold;  // Consecutive failed transactions which trip the device (0 = never)
+    int         failures;       // Consecutive failed transactions. Accessed with the lock taken.
+    int         tripped;        // The device is not reachable
+    int         trial;          // The next request to the tripped device is let through (no probe register)
+    int         failedRequests; // Requests failed while the device was not reachable
+    int         generation;     // Incremented when its registers may have changed outside the driver (trip,
+                                // recovery, configuration load). Values kept of them from before are not valid.
+    ScalVal_RO  probe;          // Register read to check if the device is reachable again
+    DoubleVal_RO probeDouble;   // Same, for devices with only floating point registers
+
+    // Only IO and timeout errors mean that the device is not reachable
+    static int resultOf(CPSWError& e)
+    {
+        if ( dynamic_cast<IOError*>(&e) || dynamic_cast<TimeoutError*>(&e) )
+            return RESULT_UNREACHABLE;
+
+        return RESULT_ERROR;
+    }
+
+    // Fail right away if the device is not reachable, unless the request is a trial
+    void checkReachable()
+    {
+        if ( epicsAtomicGetIntT(&tripped) && ( epicsAtomicCmpAndSwapIntT(&trial, 1, 0) != 1 ) )
+        {
+            epicsAtomicIncrIntT(&failedRequests);
+            throw YCPSWASYNDeviceDown(name);
+        }
+    }
+
+    // Take the lock on the given lane. Low priority requests step aside
+    // while there are high priority requests waiting for it.
+    void acquire(int lane)
+    {
+        if (lane == LANE_HIGH)
+        {
+            epicsAtomicIncrIntT(&highWaiting);
+            lock.lock();
+            epicsAtomicDecrIntT(&highWaiting);
+            highDone.signal();
+            return;
+        }
+
+        for(;;)
+        {
+            lock.lock();
+            if (!epicsAtomicGetIntT(&highWaiting))
+                return;
+            lock.unlock();
+            highDone.wait(LANE_YIELD_TIMEOUT);
+        }
+    }
+
+    // Trip the device right away, e.g. when it did not answer the startup prefetch.
+    // Called with the lock taken. Returns false if it was already tripped.
+    bool trip()
+    {
+        failures = tripThreshold;
+
+        if (epicsAtomicGetIntT(&tripped))
+            return false;
+
+        epicsAtomicSetIntT(&tripped, 1);
+        epicsAtomicIncrIntT(&generation);
+        return true;
+    }
+
+    // Release the lock, accounting the result (see transactionResultList) of the
+    // transactions done with it. Other errors, and RESULT_NONE, don't change the
+    // count of failures.
+    void release(int result)
+    {
+        bool trip = false;
+        bool back = false;
+
+        if (result == RESULT_SUCCESS)
+        {
+            failures = 0;
+
+            // A trial request succeeded
+            if (epicsAtomicGetIntT(&tripped))
+            {
+                epicsAtomicSetIntT(&tripped, 0);
+                back = true;
+            }
+        }
+        else if ( ( result == RESULT_UNREACHABLE ) && ( tripThreshold > 0 ) && ( ++failures == tripThreshold ) )
+        {
+            epicsAtomicSetIntT(&tripped, 1);
+            trip = true;
+        }
+
+        if ( trip || back )
+            epicsAtomicIncrIntT(&generation);
+
+        lock.unlock();
+
+        if (trip)
+            printf("Device %s is not reachable after %d failed transactions. Requests to it will fail until it is back.\n",
+                name.c_str(), tripThreshold);
+        else if (back)
+            printf("Device %s is reachable again\n", name.c_str());
+    }
+};
+
+// Scoped lock of a device, taken on a lane. The transactions done in the scope
+// succeeded unless fail() is called, from the handler of the CPSW error.
+class YCPSWASYNDeviceGuard
+{
+    private:
+        YCPSWASYNDevice *dev_;
+        int             result_;
+
+    public:
+        YCPSWASYNDeviceGuard(YCPSWASYNDevice *dev, int lane)
+        :
+            dev_(dev),
+            result_(RESULT_SUCCESS)
+        {
+            dev_->checkReachable();
+            dev_->acquire(lane);
+        }
+
+        // The device did not answer
+        void fail()
+        {
+            result_ = RESULT_UNREACHABLE;
+        }
+
+        // A transaction failed with the given error
+        void fail(CPSWError& e)
+        {
+            result_ = YCPSWASYNDevice::resultOf(e);
+        }
+
+        ~YCPSWASYNDeviceGuard()
+        {
+            dev_->release(result_);
+        }
+};
+
+// Fields of an input array register, which are read together with one
+// transaction and published each on its own parameter. Only the elements of one
+// enum array register form a group: CPSW gives no interface to the hardware word
+// shared by separate registers, so separate bit fields are not grouped.
+struct YCPSWASYNFieldGroup
+{
+    ScalVal_RO              reg;        // Array register
+    YCPSWASYNDevice         *dev;       // Device of the register
+    std::vector<int>        params;     // Parameter index (on DEV_REG_RO) of each field (-1 if none)
+    std::vector<uint64_t>   buffer;     // Values read. Accessed with the device lock taken.
+};
+
+struct YCPSWASYNRecordRequest;
+
+// Word of an RW register accessed through the digital interface, e.g. by the bo and
+// mbbo records of its bit fields. The field writes queued to the workers are merged,
+// and written together with one masked read-modify-write transaction. The value of
+// the word (shadow) is kept from the last write or read, so the word is only read
+// back when it is not known: before the first access, after a failure, or when the
+// generation of the device changed.
+struct YCPSWASYNRegisterWord
+{
+    YCPSWASYNRegisterWord() : shadow(0), shadowValid(false), shadowGeneration(0), pendingValue(0), pendingMask(0), committing(false) {}
+
+    // Keep the value of the word read or written. Called with the device lock taken.
+    void keep(uint32_t value, int generation)
+    {
+        shadow           = value;
+        shadowValid      = true;
+        shadowGeneration = generation;
+    }
+
+    uint32_t    shadow;             // Value of the word. Accessed with the device lock taken.
+    bool        shadowValid;        // The shadow holds the value of the word
+    int         shadowGeneration;   // Generation of the device when the shadow was kept
+    epicsUInt32 pendingValue;       // Bits to write, merged from the writes not committed yet.
+    epicsUInt32 pendingMask;        // Accessed with the port lock taken, as the fields below.
+    bool        committing;         // A job committing the pending bits is queued
+    std::vector<YCPSWASYNRecordRequest*> waiting; // Records completed when the pending bits are committed
+};
+
+// CPSW interface of a register. It is either given when the register is added, or
+// created from the register path the first time it is used (see YCPSWASYN::lazyInterfaces).
+// The creation can be done by any thread; it throws a CPSWError if it fails.
+template <typename T>
+class YCPSWASYNInterface
+{
+    private:
+        T                   reg_;
+        Path                path_;      // Path the interface is created from
+        int                 created_;   // The interface is available on reg_
+        static epicsMutex   createLock_;
+
+    public:
+        YCPSWASYNInterface() : created_(0) {}
+
+        YCPSWASYNInterface& operator=(const T& reg)
+        {
+            reg_     = reg;
+            created_ = 1;
+            return *this;
+        }
+
+        // Create the interface from the path on first use
+        void defer(const Path& p)
+        {
+            reg_.reset();
+            path_    = p;
+            created_ = 0;
+        }
+
+        // The register was added, with its interface or with its path
+        bool present() const
+        {
+            return path_ || created_;
+        }
+
+        bool created() const
+        {
+            return epicsAtomicGetIntT(&created_);
+        }
+
+        const T& get()
+        {
+            if (!epicsAtomicGetIntT(&created_))
+            {
+                epicsGuard<epicsMutex> g(createLock_);
+
+                if (!created_)
+                {
+                    if (!path_)
+                        throw CPSWError("No register attached to this parameter");
+
+                    reg_ = T::element_type::create(path_);
+                    epicsAtomicSetIntT(&created_, 1);
+                }
+            }
+
+            return reg_;
+        }
+
+        typename T::element_type *operator->()
+        {
+            return get().get();
+        }
+};
+
+template <typename T>
+epicsMutex YCPSWASYNInterface<T>::createLock_;
+
+// Register interface, and the device it belongs to
+template <typename T>
+struct YCPSWASYNRegister
+{
+    YCPSWASYNInterface<T> reg;
+    YCPSWASYNDevice  *dev;
+    bool             readPending;   // An asynchronous read of this register is in flight
+    std::vector<uint64_t> scratch;  // Conversion buffer, for arrays which can not be read directly into the client buffer
+    int              ofsParam;      // Array window offset parameter index (-1 if the register is not an array)
+    int              lenParam;      // Array window length parameter index (-1 if the register is not an array)
+    std::vector<uint8_t> committed; // Last value written to the whole array, used to send only the elements that changed
+    std::vector<uint8_t> check;     // Buffer the first chunk of an array read in chunks is read back into, to detect changes during the transfer
+    int              committedGeneration; // Generation of the device when the committed value was written
+    YCPSWASYNFieldGroup *group;     // Group the register is read with (NULL if none)
+    bool             prefetched;    // The parameter holds the value read by the startup prefetch, not yet returned to a client
+    YCPSWASYNRegisterWord *word;    // Word of an RW register accessed through the digital interface (NULL until its first
+                                    // digital access). Created with the port lock taken.
+
+    YCPSWASYNRegister() : dev(NULL), readPending(false), ofsParam(-1), lenParam(-1), committedGeneration(0),
+                          group(NULL), prefetched(false), word(NULL) {}
+
+    // Get the conversion buffer. It is allocated on first use and reused afterwards.
+    uint64_t *scratchBuffer(size_t n)
+    {
+        if (scratch.size() < n)
+            scratch.resize(n);
+        return &scratch[0];
+    }
+};
+
+// Table of register interfaces, indexed by asyn parameter index.
+// The table grows as parameters are added, so it is only as large as the
+// number of parameters created on its parameter list.
+template <typename T>
+class YCPSWASYNRegisterTable
+{
+    private:
+        std::vector< YCPSWASYNRegister<T> > regs_;
+        size_t                              count_;
+
+    public:
+        YCPSWASYNRegisterTable() : count_(0) {}
+
+        // Add a register at the given parameter index, growing the table if needed
+        void insert(int index, const T& reg, YCPSWASYNDevice *dev)
+        {
+            slot(index, dev).reg = reg;
+        }
+
+        // Add a register whose interface is created from its path on first use
+        void defer(int index, const Path& p, YCPSWASYNDevice *dev)
+        {
+            slot(index, dev).reg.defer(p);
+        }
+
+        // Check if there is a register at the given parameter index
+        bool contains(int index) const
+        {
+            return ( index >= 0 ) && ( static_cast<size_t>(index) < regs_.size() ) && regs_[index].reg.present();
+        }
+
+        // Get the register at the given parameter index. Throws if there is none.
+        YCPSWASYNRegister<T>& at(int index)
+        {
+            if ( (index < 0) || (static_cast<size_t>(index) >= regs_.size()) || (!regs_[index].reg.present()) )
+                throw CPSWError("No register attached to this parameter");
+
+            return regs_[index];
+        }
+
+        // Number of registers whose interface has not been created yet
+        size_t deferred() const
+        {
+            size_t n = 0;
+
+            for (size_t i = 0; i < regs_.size(); ++i)
+                if ( regs_[i].reg.present() && !regs_[i].reg.created() )
+                    ++n;
+
+            return n;
+        }
+
+        // Release the extra capacity left after the table has been filled
+        void compact()
+        {
+            std::vector< YCPSWASYNRegister<T> >(regs_).swap(regs_);
+        }
+
+        size_t count()    const { return count_; }
+        size_t slots()    const { return regs_.size(); }
+        size_t memUsage() const { return regs_.capacity() * sizeof(YCPSWASYNRegister<T>); }
+
+    private:
+        YCPSWASYNRegister<T>& slot(int index, YCPSWASYNDevice *dev)
+        {
+            if (index < 0)
+                throw CPSWError("Invalid parameter index for register table");
+
+            if (static_cast<size_t>(index) >= regs_.size())
+                regs_.resize(index + 1);
+
+            if (!regs_[index].reg.present())
+                ++count_;
+
+            regs_[index].dev = dev;
+
+            return regs_[index];
+        }
+};
+
+class YCPSWASYN;
+
+// Register read by the startup prefetch
+struct YCPSWASYNPrefetchEntry
+{
+    int             list;           // Parameter list
+    int             index;          // Parameter index
+    asynParamType   type;           // Parameter type
+    bool            *prefetched;    // Prefetched flag of the register
+    uint32_t        u32;            // Value read (integer registers)
+    double          f64;            // Value read (floating point registers)
+    bool            valid;          // The value was read successfully
+};
+
+// Registers of one device, read together with one device lock by the startup prefetch
+struct YCPSWASYNPrefetchBatch
+{
+    YCPSWASYN                           *drv;       // Port (or shard) the registers belong to
+    YCPSWASYNDevice                     *dev;       // Device of the registers
+    std::vector<YCPSWASYNPrefetchEntry> entries;
+};
+
+// Batches of the startup prefetch, shared by the prefetch threads
+struct YCPSWASYNPrefetch
+{
+    YCPSWASYNPrefetch() : next(0), running(0) {}
+
+    std::vector<YCPSWASYNPrefetchBatch> batches;
+    int                                 next;       // Next batch to read
+    int                                 running;    // Number of threads still running
+    epicsEvent                          done;       // Signaled when the last thread ends
+};
+
+// Ports whose initialization was deferred. Their discovery is run concurrently by
+// YCPSWASYNInitPorts, one thread per port.
+struct YCPSWASYNPortDiscovery
+{
+    YCPSWASYNPortDiscovery() : next(0), running(0) {}
+
+    std::vector<YCPSWASYN*> ports;
+    std::vector<double>     seconds;    // Wall clock time of the discovery of each port
+    int                     next;       // Next port to discover
+    int                     running;    // Number of threads still running
+    epicsEvent              done;       // Signaled when the last thread ends
+};
+
+// Scope of a CPSW transaction. The port lock is released, so that the parameter
+// library can be used by other threads while waiting for the hardware, and the
+// device lock (if any) is held instead, taken on the given lane. The port lock is
+// taken back at the end, and the latency of the transaction is added to the lane.
+class YCPSWASYNTransaction
+{
+    private:
+        YCPSWASYN        *drv_;
+        YCPSWASYNDevice  *dev_;
+        int              lane_;
+        int              result_;
+        epicsTimeStamp   start_;
+
+    public:
+        YCPSWASYNTransaction(YCPSWASYN *drv, YCPSWASYNDevice *dev, int lane = LANE_LOW);
+        ~YCPSWASYNTransaction();
+
+        // A transaction failed with the given error. Called from its handler, inside the scope.
+        void fail(CPSWError& e)
+        {
+            result_ = YCPSWASYNDevice::resultOf(e);
+        }
+};
+
+// Scope of a configuration load or save, which accesses the registers of all the
+// devices of a port and its shards. The port lock is released, and the locks of all
+// these devices are held instead, so register accesses are not done in the middle
+// of it. The locks are taken in address order, on the high priority lane. The
+// transactions are not accounted on the health of the devices nor on the latency.
+// After a load, even a failed one, the generation of the devices is incremented.
+class YCPSWASYNConfigTransaction
+{
+    private:
+        YCPSWASYN                   *drv_;
+        bool                        load_;
+        std::set<YCPSWASYNDevice*>  devs_;
+
+    public:
+        YCPSWASYNConfigTransaction(YCPSWASYN *drv, bool load);
+        ~YCPSWASYNConfigTransaction();
+};
+
+// Job run by a worker of a YCPSWASYNWorkerPool
+class YCPSWASYNJob
+{
+    public:
+        YCPSWASYNJob(int lane = LANE_LOW) : lane(lane) {}
+        virtual ~YCPSWASYNJob() {}
+        virtual void run() = 0;
+
+        int             lane;       // Lane the job is queued on (see requestLaneList)
+        epicsTimeStamp  queued;     // Time the job was queued
+};
+
+// Pool of worker threads running YCPSWASYNJobs. Jobs queued with the same
+// key are run by the same worker, in order on each lane, with the jobs on
+// the high priority lane run first; jobs with different keys can run
+// concurrently and complete out of order.
+class YCPSWASYNWorkerPool
+{
+    public:
+        YCPSWASYNWorkerPool(const std::string& name, int nWorkers);
+
+        // Queue a job. The pool takes ownership of it and deletes it once run.
+        void   queue(YCPSWASYNJob *job, size_t key);
+        size_t size() const { return workers_.size(); }
+
+    private:
+        struct Worker
+        {
+            epicsMutex                  lock;
+            epicsEvent                  event;
+            std::deque<YCPSWASYNJob*>   jobs[LANE_SIZE];  // Jobs on each lane
+        };
+
+        static void workerTask(void *arg);
+
+        std::vector<Worker*>  workers_;
+};
+
+// Asynchronous register accesses. Writes go after reads.
+enum registerJobList
+{
+    JOB_READ_INT32,
+    JOB_READ_DIGITAL,
+    JOB_READ_FLOAT64,
+    JOB_WRITE_INT32,
+    JOB_WRITE_DIGITAL,
+    JOB_WRITE_FLOAT64,
+    JOB_EXECUTE_COMMAND
+};
+
+// Register access of a record using the asynchronous device support. The record
+// is left active (PACT set) while the access is queued, and is processed again
+// by the callback when the worker has completed it.
+struct YCPSWASYNRecordRequest
+{
+    YCPSWASYNRecordRequest() : rec(NULL), drv(NULL), addr(-1), function(-1), type(JOB_READ_INT32),
+                               mask(0xFFFFFFFF), u32(0), f64(0), status(0), down(false) {}
+
+    CALLBACK    callback;
+    dbCommon    *rec;       // Record processed when the access is completed
+    YCPSWASYN   *drv;       // Port (or shard) of the register
+    int         addr;       // Parameter list
+    int         function;   // Parameter index
+    int         type;       // Type of access (see registerJobList)
+    epicsUInt32 mask;       // Mask of the digital interface
+    epicsUInt32 u32;        // Value read or to write (integer registers)
+    double      f64;        // Value read or to write (floating point registers)
+    int         status;     // 0 if the access succeeded, -1 if it failed
+    bool        down;       // The access failed because the device is not reachable
+};
+
+// Array read of a waveform record using the asynchronous device support. The window
+// of the register is read in chunks, each one by its own job on the low priority lane,
+// so the requests queued to the device in the meantime are served between chunks. The
+// elements are read into the request buffer, and copied to the record when it completes.
+struct YCPSWASYNArrayRequest
+{
+    YCPSWASYNArrayRequest() : rec(NULL), drv(NULL), addr(-1), function(-1), ftvl(0), elementSize(0), nelm(0),
+                              first(0), n(0), chunk(0), done(0), got(0), checked(false), changed(false), status(0), down(false) {}
+
+    CALLBACK    callback;
+    dbCommon    *rec;           // Record processed when the read is completed
+    YCPSWASYN   *drv;           // Port (or shard) of the register
+    int         addr;           // Parameter list
+    int         function;       // Parameter index
+    int         ftvl;           // Element type of the record (menuFtype)
+    size_t      elementSize;    // Size of an element (bytes)
+    size_t      nelm;           // Max number of elements of the record
+    size_t      first;          // First element of the window
+    size_t      n;              // Number of elements to read
+    size_t      chunk;          // Number of elements read by each job
+    size_t      done;           // Number of elements read so far
+    size_t      got;            // Number of elements CPSW returned
+    bool        checked;        // The first chunk was read again
+    bool        changed;        // The first chunk changed during the transfer
+    int         status;         // 0 if the read succeeded, -1 if it failed
+    bool        down;           // The read failed because the device is not reachable
+    std::vector<uint8_t> buffer; // Elements read. Accessed by the worker while the read is in flight.
+    std::vector<uint8_t> check;  // First chunk read again
+};
+
+// One chunk of an array read, run by a worker. It queues a job for the next one.
+class YCPSWASYNArrayJob : public YCPSWASYNJob
+{
+    public:
+        YCPSWASYNArrayJob(YCPSWASYNArrayRequest *request) : YCPSWASYNJob(LANE_LOW), request(request) {}
+
+        virtual void run();
+
+        YCPSWASYNArrayRequest *request;
+};
+
+// Register access handed to the worker pool of a port in asynchronous mode
+class YCPSWASYNRegisterJob : public YCPSWASYNJob
+{
+    public:
+        // Writes and commands go on the high priority lane
+        YCPSWASYNRegisterJob(YCPSWASYN *drv, int type, int addr, int function)
+        :
+            YCPSWASYNJob( ( type >= JOB_WRITE_INT32 ) ? LANE_HIGH : LANE_LOW ),
+            drv(drv),
+            type(type),
+            addr(addr),
+            function(function),
+            u32(0),
+            mask(0xFFFFFFFF),
+            f64(0),
+            readPending(NULL),
+            request(NULL)
+        {
+        }
+
+        virtual void run();
+
+        YCPSWASYN   *drv;
+        int         type;       // Type of access (see registerJobList)
+        int         addr;       // Parameter list
+        int         function;   // Parameter index
+        epicsUInt32 u32;        // Value to write (integer registers)
+        epicsUInt32 mask;       // Mask to read (digital interface)
+        double      f64;        // Value to write (floating point registers)
+        bool        *readPending; // In flight flag of the register, cleared when a read completes
+        YCPSWASYNRecordRequest *request; // Request of the record waiting for the access (NULL if none)
+};
 
 class YCPSWASYNRAIIFile;
+class YCPSWASYNGenerateDB;
 class YCPSWKeysNotFound;
 
 class YCPSWASYN : public asynPortDriver
@@ -239,6 +1087,10 @@ class YCPSWASYN : public asynPortDriver
         virtual asynStatus  writeInt32          (asynUser *pasynUser, epicsInt32 value);
         virtual asynStatus  readFloat64         (asynUser *pasynUser, epicsFloat64 *value);
         virtual asynStatus  writeFloat64        (asynUser *pasynUser, epicsFloat64 value);
+        virtual asynStatus  readInt8Array       (asynUser *pasynUser, epicsInt8 *value, size_t nElements, size_t *nIn);
+        virtual asynStatus  writeInt8Array      (asynUser *pasynUser, epicsInt8 *value, size_t nElements);
+        virtual asynStatus  readInt16Array      (asynUser *pasynUser, epicsInt16 *value, size_t nElements, size_t *nIn);
+        virtual asynStatus  writeInt16Array     (asynUser *pasynUser, epicsInt16 *value, size_t nElements);
         virtual asynStatus  readInt32Array      (asynUser *pasynUser, epicsInt32 *value, size_t nElements, size_t *nIn);
         virtual asynStatus  writeInt32Array     (asynUser *pasynUser, epicsInt32 *value, size_t nElements);
         virtual asynStatus  readOctet           (asynUser *pasynUser, char *value, size_t maxChars, size_t *nActual, int *eomReason);
@@ -260,13 +1112,78 @@ class YCPSWASYN : public asynPortDriver
         // Create a record from a Path
         virtual int  CreateRecord(Path p);
 
+        // Create a record from a Path, and the CPSW interfaces already attached to it
+        int CreateRecord(Path p, const YCPSWASYNInterfaces& ifs);
+
+        // Time the iocInit phase of all ports
+        static void startupInitHook(initHookState state);
+
+        // Attach a record of the asynchronous device support to the register of a parameter.
+        // Returns false if the parameter is not a scalar register, or the port is synchronous.
+        bool initRecordRequest(YCPSWASYNRecordRequest *req, const char *param);
+
+        // Get the value the parameter of a record of the asynchronous device support holds.
+        // Returns false if it has none.
+        bool getRecordValue(YCPSWASYNRecordRequest *req);
+
+        // Queue the register access of a record of the asynchronous device support. Returns
+        // false if the access was completed right away, without queuing it.
+        bool queueRecordRequest(YCPSWASYNRecordRequest *req);
+
+        // Attach a waveform record of the asynchronous device support to the array register of a
+        // parameter. Returns false if the parameter is not an array register of a type the record
+        // can hold, or the port is synchronous.
+        bool initArrayRequest(YCPSWASYNArrayRequest *req, const char *param);
+
+        // Queue the array read of a waveform record of the asynchronous device support. Returns
+        // false if the window is empty, and nothing is read.
+        bool queueArrayRequest(YCPSWASYNArrayRequest *req);
+
+        // Add a path filter ("include" or "exclude") for the auto-generation. Returns false if it is not valid.
+        static bool addPathFilter(const std::string& action, const std::string& pattern);
+
+        // Check if a CPSW path matches a filter
+        static bool pathMatches(const YCPSWASYNPathFilter& f, const std::string& path);
+
+        // Initialize the ports whose initialization was deferred: their discovery is run
+        // concurrently, and then their records are loaded one port at a time
+        static int initDeferredPorts(void);
+
+        // Attach the CPSW interfaces to a register path. Only does CPSW calls, so it
+        // can run on several threads at the same time. The interfaces are probed once
+        // per field; the other leaves of the field only get the interfaces it supports.
+        static void createInterfaces(Path p, YCPSWASYNInterfaces& ifs);
+
         // Default parameters, which can be changed from the IOC shell
         static double       defaultScan;      // Default SCAN value for PVs
         static unsigned int recordNameLenMax; // Max length of the record name
         static std::string  mapFilePath;      // Path to map file used in auto-generation mode
         static std::string  debugFilePath;    // Path to dump debug information files
+        static int          shardCount;       // Number of shards auto-generated registers are split across
+        static int          shardKeyMode;     // How registers are assigned to shards (see shardKeyModeList)
+        static int          asyncWorkers;     // Number of workers for asynchronous register accesses (0 = synchronous)
+        static double       asyncPollPeriod;  // Period (seconds) of the asynchronous reads of the I/O Intr registers (0 = no poll)
+        static int          arrayChunkSize;   // Max number of array elements transferred per transaction (0 = no limit)
+        static int          prefetchThreads;  // Number of threads reading the registers at startup (0 = no prefetch)
+        static int          deviceTripCount;  // Consecutive failed transactions which trip a device (0 = never)
+        static int          discoveryThreads; // Number of threads attaching the register interfaces during the auto-generation
+        static std::string  generationCachePath; // Path to the auto-generation cache files (empty = no cache)
+        static int          batchLoad;        // Load the auto-generated records with one dbLoadRecords call (0 = one call per record)
+        static int          lazyInterfaces;   // Create the interfaces of the cached registers on first access (0 = at startup)
+        static std::vector<YCPSWASYNPathFilter> pathFilters; // Include/exclude filters on the paths of the auto-generated registers
+        static int          deferredInit;     // YCPSWASYNConfig only registers the port, initialized by YCPSWASYNInitPorts (0 = initialize it)
+        static double       deviceProbePeriod;// Period (seconds) of the probe reads of tripped devices
 
     private:
+        friend class YCPSWASYNRegisterJob;
+        friend class YCPSWASYNArrayJob;
+        friend class YCPSWASYNTransaction;
+        friend class YCPSWASYNConfigTransaction;
+        friend class YCPSWASYNGenerateDB;
+
+        // Constructor for a shard of the given (main) port
+        YCPSWASYN(const char *portName, Path p, YCPSWASYN *mainPort);
+
         const char                          *driverName_;               // Name of the driver (passed from st.cmd)
         Path                                p_;                         // Path on root
         const char                          *portName_;                 // Name of the port (passed from st.cmd)
@@ -274,14 +1191,23 @@ class YCPSWASYN : public asynPortDriver
         long                                nRO, nRW, nCMD, nSTM;       // Counter for RO/RW register, command and Streams found on the YAML file
         long                                nFO, nFW;                   // Counter for Floating point RO/RW registers
         long                                recordCount;                // Counter for the total number of register loaded
-        ScalVal                             rw[NUM_SCALVALS];           // Array of ScalVals (RW)
-        ScalVal_RO                          ro[NUM_SCALVALS];           // Array of ScalVals (RO)
-        DoubleVal                           fw[NUM_DOUBLEVALS];         // Array of DoubleVals (RW)
-        DoubleVal_RO                        fo[NUM_DOUBLEVALS];         // Array of DoubleVals (RO)
-        Command                             cmd[NUM_CMD];               // Array of Commands
+        YCPSWASYNRegisterTable<ScalVal>      rw;                        // Table of ScalVals (RW)
+        YCPSWASYNRegisterTable<ScalVal_RO>   ro;                        // Table of ScalVals (RO)
+        YCPSWASYNRegisterTable<DoubleVal>    fw;                        // Table of DoubleVals (RW)
+        YCPSWASYNRegisterTable<DoubleVal_RO> fo;                        // Table of DoubleVals (RO)
+        YCPSWASYNRegisterTable<Command>      cmd;                       // Table of Commands
+        std::map<std::string, YCPSWASYNDevice*> devices_;               // Devices where the registers are located
         YCPSWASYNRAIIFile                   *pvDumpFile;                // File with the list of PVs
         YCPSWKeysNotFound                   *keysNotFound;              // Set of name of elements not found on the substitution map
-        std::map<std::string, std::string>  mapTop, map;                // Substitution maps
+        YCPSWASYNRAIIFile                   *genCacheFile;              // Auto-generation cache being written (NULL = not writing)
+        YCPSWASYNRAIIFile                   *dbBatchFile;               // Database the auto-generated records are written to (NULL = load each record)
+        MAC_HANDLE                          *dbBatchMacros_;            // Macros used to expand the records written to the database
+        std::vector<char>                   dbBatchBuffer_;             // Expanded record
+        std::map<std::string, std::string>  templates_;                 // Text of each record template, read once (empty if not found)
+        boost::unordered_map<std::string, std::string> mapTop, map;     // Substitution maps
+        boost::unordered_map<std::string, std::string> namePrefixes_;   // Record name prefix of each hub path (auto-generation mode 1)
+        boost::unordered_map<std::string, std::string> hashedNames_;    // Record name of each register name and suffix (auto-generation mode 2)
+        std::map<Enum, std::string>         mbbxDbParams_;              // MBBx record parameters of each enum
         int                                 loadConfigValue_;           // Load configuration parameter index
         int                                 saveConfigValue_;           // Save configuration parameter index
         int                                 loadConfigFileValue_;       // Save configuration file name parameter index
@@ -295,16 +1221,180 @@ class YCPSWASYN : public asynPortDriver
         std::string                         loadConfigRootPath;         // Load configuration cpsw root
         std::string                         saveConfigRootPath;         // Save configuration cpsw root
         int                                 autogenerationMode_;        // DB auto-generation mode
-
-        // Automatic generation of database from YAML definition  routine
+        std::vector<YCPSWASYN*>             shards_;                    // Shards of this port. The first one is this port.
+        std::map<std::string, YCPSWASYN*>   subtreeShards_;             // Shard assigned to each top level subtree
+        YCPSWASYN                           *currentShard_;             // Shard where the register being created goes to
+        YCPSWASYNWorkerPool                 *workers_;                  // Workers for asynchronous register accesses (NULL = synchronous)
+        std::set<int>                       windowParams_[MAX_SIGNALS]; // Array window parameters on each parameter list
+        std::vector<YCPSWASYNFieldGroup*>   fieldGroups_;               // Groups of fields read together
+        std::map<int, YCPSWASYNCommandStatus> commandStatus_;           // Execution state of each command
+        YCPSWASYNWorkerPool                 *commandExecutor_;          // Thread where commands are executed
+        YCPSWASYNLatencyStats               latency_[LANE_SIZE];        // Latency statistics of each lane
+        int                                 latencyResetValue_;         // Latency statistics reset parameter index
+        int                                 devicesDownValue_;          // Number of tripped devices parameter index
+        int                                 deviceErrorsValue_;         // Requests failed on tripped devices parameter index
+        YCPSWASYNPhaseStats                 phases_[PHASE_SIZE];        // Time spent on each startup phase
+        YCPSWASYNPhaseStats                 total_;                     // Time of the whole startup of the port, without iocInit.
+                                                                        // Timed on its own, as some phases are nested in others.
+        static YCPSWASYNPhaseStats          initPhase_;                 // Time of the last YCPSWASYNInit, added to the next port
+        static std::vector<YCPSWASYN*>      ports_;                     // Ports created, whose iocInit phase is timed
+        static YCPSWASYNPhaseStats          iocInitPhase_;              // Time of iocInit, shared by all ports
+        static YCPSWASYNPhaseTimer          *iocInitTimer_;             // Times iocInit, while it runs
+        static epicsMutex                   leafClassLock_;             // Protects the leaf classes, used by the discovery threads
+        static std::map<Child, YCPSWASYNLeafClass> leafClasses_;        // Kind of the registers of each field probed
+        static unsigned long                exceptionsAvoided_;         // Exceptions not thrown thanks to the leaf classes
+        static std::vector<YCPSWASYN*>      deferredPorts_;             // Ports waiting for YCPSWASYNInitPorts
+        std::string                         dictionary_;                // Dictionary file (passed from st.cmd)
+        YCPSWASYNGenerateDB                 *generateDB_;               // Registers discovered, waiting for their records (NULL = none)
+        std::vector<YCPSWASYNCacheEntry>    cacheEntries_;              // Entries read from the auto-generation cache
+        std::string                         cacheFileName_;             // Auto-generation cache file
+        std::string                         cacheKey_;                  // Key of the auto-generation cache (empty = no cache)
+        bool                                cached_;                    // The records are loaded from the auto-generation cache
+
+        // Discovery phase of the initialization: find the registers, and attach their interfaces.
+        // It doesn't create records nor parameters, so it can run concurrently with other ports.
+        void discoverDatabase(void);
+        static void discoveryPortTask(void *arg);
+
+        // Rest of the initialization: records, parameters and prefetch
+        void completeInit(void);
+
+        // Automatic generation of database from YAML definition  routine. Creates the records of
+        // the registers found by discoverDatabase.
         int autogenerateDatabase(void);
 
+        // Prefix of the debug information files of this port: <debugFilePath>/<PORT>_[<PREFIX>_]
+        std::string debugFilePrefix(void);
+
+        // Print the time spent on each startup phase, and write it to a JSON file
+        void printStartupProfile(FILE *fp);
+        void writeStartupProfile(void);
+
+        // Key of the auto-generation cache: hash of the YAML hierarchy, the substitution maps and the
+        // settings used to name the records. Returns an empty string if it can not be computed.
+        std::string generationCacheKey(const std::string& pre);
+
+        // Read the entries of the auto-generation cache, if it has the given key, and create their CPSW
+        // interfaces. Returns false if the cache can't be used.
+        bool readGenerationCache(const std::string& fileName, const std::string& key, std::vector<YCPSWASYNCacheEntry>& entries);
+
+        // Load the records of the entries read from the auto-generation cache
+        void loadGenerationCache(const std::vector<YCPSWASYNCacheEntry>& entries);
+
+        // Probe the CPSW interfaces supported by a register path, attaching them
+        static YCPSWASYNLeafClass probeInterfaces(Path p, YCPSWASYNInterfaces& ifs);
+
+        // Attach the CPSW interfaces of a kind of register. Returns false if they are not supported.
+        static bool createInterfaces(Path p, int kind, YCPSWASYNInterfaces& ifs);
+
+        // Name of a register path relative to the root path of this port, used on the auto-generation cache
+        std::string relativePathName(const Path& p);
+
+        // Create the shards used to split auto-generated registers
+        void createShards(void);
+
+        // Select the shard for the register at the given path
+        YCPSWASYN *selectShard(const Path& p);
+
+        // Queue an asynchronous register access. Reads already in flight are not queued again.
+        void queueRegisterJob(YCPSWASYNRegisterJob *job, YCPSWASYNDevice *dev, bool *readPending = NULL);
+
+        // Do an asynchronous register access, from a worker thread
+        void processRegisterJob(YCPSWASYNRegisterJob *job);
+
+        // Read the next chunk of an asynchronous array read, from a worker thread
+        void processArrayJob(YCPSWASYNArrayJob *job);
+
+        // Read the next chunk of an array read into the request buffer, or read the first chunk
+        // again once all were read. Called with the device lock taken.
+        template <typename T, typename V>
+        void readArrayChunk(YCPSWASYNRegister<T>& r, YCPSWASYNArrayRequest *req);
+        template <typename T>
+        void readIntArrayChunk(YCPSWASYNRegister<T>& r, YCPSWASYNArrayRequest *req);
+
+        // Poll thread: periodically queues the asynchronous reads of the registers with I/O Intr records
+        static void pollTask(void *arg);
+        void pollRegisters(void);
+        void queueInterruptReads(void);
+
+        // Read all scalar registers of this port and its shards into the parameter library, in parallel per device
+        void prefetchRegisters(void);
+
+        // Add the scalar registers of a table to the prefetch batch of their device
+        template <typename T>
+        void addPrefetchEntries(YCPSWASYNRegisterTable<T>& table, int list, std::map<YCPSWASYNDevice*, YCPSWASYNPrefetchBatch>& batches);
+
+        // Read the registers of a prefetch batch, from a prefetch thread. The batch is aborted, and
+        // the device tripped, when the device does not answer.
+        void prefetchBatch(YCPSWASYNPrefetchBatch& b);
+
+        // Prefetch thread: reads batches until there are none left
+        static void prefetchTask(void *arg);
+
+        // Report a CPSW error on a request. Errors of tripped devices are only counted, and set a
+        // COMM alarm. Returns the status of the request.
+        int reportError(asynUser *pasynUser, const char *functionName, const char *name, CPSWError& e);
+
+        // Probe thread: periodically reads the tripped devices, and updates the device health parameters
+        static void healthTask(void *arg);
+        void probeDevices(void);
+
+        // Create the latency statistics parameters of each lane
+        void createLatencyParams(void);
+
+        // Add a request served on a lane to its latency statistics, with the given
+        // latency (seconds) or with the time elapsed since it started
+        void addLatency(int lane, double latency);
+        void addLatency(int lane, const epicsTimeStamp& since);
+
+        // Clear the latency statistics of all lanes
+        void resetLatency(void);
+
+        // Create the status parameters of a command
+        void createCommandStatus(int paramIndex);
+
+        // Report the end of a command execution
+        void finishCommand(int function, int status, double duration);
+
+        // Word of an RW register accessed through the digital interface, created on first use
+        YCPSWASYNRegisterWord *registerWord(YCPSWASYNRegister<ScalVal>& r);
+
+        // Write the bits of a mask of the word of an RW register, with one masked read-modify-write
+        // transaction. Returns the value written.
+        uint32_t commitRegisterWord(YCPSWASYNRegister<ScalVal>& r, epicsUInt32 value, epicsUInt32 mask);
+
+        // Field group of the elements of an input enum array register, read with one transaction
+        YCPSWASYNFieldGroup *createFieldGroup(const ScalVal_RO& reg, const Path& p);
+        void addToFieldGroup(YCPSWASYNFieldGroup *g, int paramIndex, int element);
+        void readFieldGroup(YCPSWASYNFieldGroup *g);
+
+        // Create the window (offset/length) parameters of an array register
+        template <typename T>
+        void createArrayWindow(YCPSWASYNRegister<T>& r, int list, int paramIndex, unsigned nelms);
+
+        // Get the elements of an array register to transfer, from its window and the client request
+        template <typename T>
+        void getArrayWindow(YCPSWASYNRegister<T>& r, int list, size_t nElements, size_t& first, size_t& n);
+
+        // Read the window of an array register into an asyn client buffer, in chunks. If the array changed
+        // during the transfer, a read alarm is set on the asyn user. Returns the number of elements read.
+        template <typename T, typename V>
+        size_t readRegisterArray(YCPSWASYNRegister<T>& r, int list, V *value, size_t nElements, asynUser *pasynUser);
+
+        // Write an asyn client buffer into the window of an array register, in chunks, sending only
+        // the elements that changed since the last write. Returns the number of elements written.
+        template <typename T, typename V>
+        size_t writeRegisterArray(YCPSWASYNRegister<T>& r, int list, V *value, size_t nElements);
+
         // Load database from dictionary file routine
         int loadDBFromFile(const char* dictionary);
 
         // Create the record name from its path
         std::string generateRecordName(const Path& p, const std::string& suffix);
 
+        // Record name prefix of the registers in a hub path, built from the prefix of its parent
+        std::string getNamePrefix(const Path& p);
+
         // Create a record from a register pointer
         template <typename T>
         int CreateRecord(const T& reg);
@@ -318,8 +1408,19 @@ class YCPSWASYN : public asynPortDriver
         template <typename T>
         int CreateRecordFloat(const T& reg);
 
-        // Load a EPICS record with the provided information
-        int LoadRecord(int regType, const recordParams& rp, const std::string& dbParams, Path p);
+        // Load a EPICS record with the provided information. element is the index of the
+        // register on its array, for registers created one per array element.
+        int LoadRecord(int regType, const recordParams& rp, const std::string& dbParams, Path p, int element = -1);
+
+        // Expand a record template with the given macros and write it to the auto-generated
+        // database. Returns false if the template can't be read.
+        bool batchRecord(const std::string& recTemplate, const std::string& macros);
+
+        // Read a record template, looking for it on EPICS_DB_INCLUDE_PATH as dbLoadRecords does
+        std::string readTemplate(const std::string& name);
+
+        // Start the acquisition thread of a stream, and its parameters
+        int startStream(const Stream& reg, const Path& p, int param16index, int param32index);
 
         // Get the register type
         template <typename T>
@@ -327,9 +1428,15 @@ class YCPSWASYN : public asynPortDriver
 
         // Push the register pointer to its respective list based on the parameter index
         template <typename T>
-        void pushParameter(const T& reg, const int& paramIndex);
+        void pushParameter(const T& reg, const int& paramIndex, const Path& p);
+
+        // Push a register whose interface is created on first access, from its path
+        void deferParameter(int regType, const int& paramIndex, const Path& p);
 
-        // Extract record parameters related to MBBx records
+        // Get the device where the register at the given path is located
+        YCPSWASYNDevice *getDevice(const Path& p);
+
+        // Extract record parameters related to MBBx records (built once per enum)
         std::string extractMbbxDbParams(const Enum& isEnum);
 
         // Load configuration from YAML
@@ -343,15 +1450,20 @@ class YCPSWASYN : public asynPortDriver
 
         // Creates a parameter for the given register an add its pointer to it list
         template <typename T>
-        void addParameter(const T& reg, const std::string& paramName, const asynParamType& paramType);
+        void addParameter(const T& reg, const std::string& paramName, const asynParamType& paramType, const Path& p);
 
         // Creates a asyn parameter for the given register
         template <typename T>
-        void createRegisterParameter(const T& reg, const std::string& paramName);
+        void createRegisterParameter(const T& reg, const std::string& paramName, const Path& p);
 
         // Creates a asyn parameter for the given float register
         template <typename T>
-        void createRegisterParameterFloat(const T& reg, const std::string& paramName);
+        void createRegisterParameterFloat(const T& reg, const std::string& paramName, const Path& p);
+
+        // Update a parameter value read from a register, doing its callbacks only if it changed
+        asynStatus updateIntegerParam(int list, int index, int value);
+        asynStatus updateDoubleParam(int list, int index, double value);
+        asynStatus updateUIntDigitalParam(int list, int index, epicsUInt32 value, epicsUInt32 mask);
 
 };
 
@@ -374,25 +1486,63 @@ class YCPSWASYNRAIIFile
         virtual ~YCPSWASYNRAIIFile();
 };
 
+// Register found while walking the hierarchy, and the CPSW interfaces attached to it
+struct YCPSWASYNLeaf
+{
+    Path                p;
+    YCPSWASYNInterfaces ifs;
+    size_t              segment;    // YAML dump segment where its interface types are written
+};
+
+// Auto-generation of the database. The hierarchy is walked first, collecting the
+// registers; their CPSW interfaces are then attached in parallel (discovery phase),
+// and finally their parameters and records are created in the walk order.
 class YCPSWASYNGenerateDB : public IPathVisitor
 {
     private:
-        YCPSWASYN         *drv_;
-        int                indent_;
-        std::vector<Path>  pathStack_;
-        Path               workingPrefix_;
-        char               idx_[256];
-        YCPSWASYNRAIIFile  textFile;
+        YCPSWASYN                   *drv_;
+        int                         indent_;
+        std::vector<Path>           pathStack_;
+        Path                        workingPrefix_;
+        char                        idx_[256];
+        YCPSWASYNRAIIFile           textFile;
+        std::vector<YCPSWASYNLeaf>  leaves_;        // Registers found, in walk order
+        std::vector<std::string>    yaml_;          // YAML dump, split where the interface types go
+        int                         next_;          // Next register to discover
+        int                         running_;       // Number of discovery threads still running
+        epicsEvent                  done_;          // Signaled when the last discovery thread ends
+        std::vector<bool>           included_;      // Each level of the walk is inside an included subtree
+        size_t                      filtered_;      // Subtrees and registers left out by the path filters
 
         void processStack(unsigned level);
 
+        // Apply the path filters to a path of the walk. Returns true if it is left out.
+        bool filtered(const std::string& path, bool leaf);
+
+        // Attach the CPSW interfaces of all registers found, with discoveryThreads threads
+        void discover();
+        static void discoveryTask(void *arg);
+
     public:
         YCPSWASYNGenerateDB(const std::string &pre, YCPSWASYN *drv);
+        ~YCPSWASYNGenerateDB();
+
+        // Write on the YAML dump
+        void yamlWrite(const char *format, ...);
 
         virtual bool visitPre(ConstPath here);
         virtual void visitPost(ConstPath here);
 
-        void genereate(Path prefix);
+        // Walk the hierarchy from the prefix, and attach the interfaces of the registers found
+        void walk(Path prefix);
+
+        // Create the records of the registers found, in the walk order
+        void createRecords();
+
+        size_t filteredCount() const
+        {
+            return filtered_;
+        }
 
         int
         yamlIndent()
@@ -414,7 +1564,7 @@ class YCPSWASYNGenerateDB : public IPathVisitor
             return indent_;
         }
 
-        YCPSWASYNRAIIFile  yamlFile;
+        YCPSWASYNRAIIFile           yamlFile;
 };
 
 class YCPSWKeysNotFound
@@ -427,11 +1577,20 @@ class YCPSWKeysNotFound
         YCPSWKeysNotFound(const std::string &fileName);
         void insert(const std::string &element);
         void dump();
+
+        const std::set<std::string>& elements() const
+        {
+            return list_;
+        }
 };
 
 // Remove '[a-b]' of the name when leaf are arrays
 std::string getNameWithoutLeafIndexes(const Path& p);
 
+// Escape (and unescape) the tabs and line breaks of a field of the auto-generation cache file
+std::string escapeCacheField(const std::string& field);
+std::string unescapeCacheField(const std::string& field);
+
 // Stream handling function caller
 static void streamTaskC(void *args);
 